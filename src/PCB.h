@@ -1,5 +1,16 @@
 #include "./cpu/REGISTER_BANK.h"
 #include "./memory/MAINMEMORY.h"
+#include "./io/IO_SUBSYSTEM.h"
+#include "./cpu/INTERRUPT_CONTROLLER.h"
+#include "./cpu/RETURN_ADDRESS_STACK.h"
+#include "./cpu/EXECUTION_UNITS.h"
+#include "./cpu/PIPELINE_COUNTERS.h"
+#include "./sim/PROFILER.h"
+#include "./sim/TRACE_RECORDER.h"
+#include "./sim/HOST_COUNTERS.h"
+#include "./sim/LIVE_STATS.h"
+#include "./sim/LOCK_PROFILER.h"
+#include <atomic>
 #include <mutex>
 #include <memory>
 
@@ -8,6 +19,7 @@
 
  
 enum class State {
+    New,
     Ready,
     Blocked,
     Executing,
@@ -21,20 +33,40 @@ struct PCB{
   int baseAddr;
   int finalAddr;
   int id;
-};
-
-struct ioRequest {
-    string msg;
-    PCB* process;
+  atomic<int> pendingIO{0};      // pedidos de E/S ainda não concluídos
+  bool waitingIO = false;        // bloqueado até pendingIO chegar a zero
+  int waitingIOSpace = -1;       // dispositivo cuja fila estava cheia (-1 = nenhum)
+  uint64_t readyTime = 0;        // ciclo virtual a partir do qual pode executar
+  uint64_t arrivalTime = 0;      // ciclo em que o processo chegou
+  uint64_t finishTime = 0;       // ciclo em que executou o end
+  uint64_t readyWait = 0;        // ciclos pronto esperando um núcleo
+  uint64_t dispatches = 0;       // vezes que recebeu um núcleo
+  atomic<int> pendingDMA{0};     // transferências de DMA ainda não concluídas
+  atomic<bool> waitingDMA{false};    // bloqueado em dwait até pendingDMA chegar a zero
+  atomic<uint64_t> dmaWaitStart{0};
+  uint64_t calls = 0;            // jal executados
+  uint64_t returns = 0;          // jr $ra executados
+  uint64_t returnsMispredicted = 0;
+  uint64_t vectorInstructions = 0;
+  uint64_t vectorElements = 0;
+  PIPELINE_COUNTERS pipeline;    // de todos os quanta do processo
 };
 
 struct scheduleInfo {
     MainMemory* ram;
     vector<unique_ptr<PCB>>* processes;
-    mutex* queueLock;
-    vector<unique_ptr<ioRequest>>* ioRequests;
-    bool shutdown;
-    bool printLock;
+    PROFILED_MUTEX* queueLock;
+    IO_SUBSYSTEM* io;
+    SIM_CLOCK* clock;
+    vector<unique_ptr<INTERRUPT_CONTROLLER>> interrupts;   // um por núcleo
+    vector<RETURN_ADDRESS_STACK> returnStacks;             // um por contexto de hardware
+    vector<EXECUTION_UNITS> executionUnits;                // um por núcleo
+    vector<PIPELINE_COUNTERS> pipelineCounters;            // um por núcleo
+    PROFILER* profiler = nullptr;                          // só com --profile
+    TRACE_RECORDER* trace = nullptr;                       // só com --trace
+    HOST_COUNTERS* host = nullptr;                         // só com --perf
+    LIVE_STATS* live = nullptr;                            // só com --live
+    atomic<bool> shutdown;
 };
 
 #endif
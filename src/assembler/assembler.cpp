@@ -1,11 +1,3 @@
-/* TODO
-
-OPT:
-- lw $t0 (offset)$t1) syntax
-- jal for function call
-- jr for return
-*/
-
 #include"./assembler.h"
  
 using namespace std;
@@ -28,6 +20,24 @@ const unordered_map<string, int> instructionMap = {
     {"li", 0b001110},
     {"la", 0b001111},
     {"print", 0b010000},
+    {"dread", 0b010001},
+    {"dwrite", 0b010010},
+    {"sleep", 0b010011},
+    {"di", 0b010100},
+    {"ei", 0b010101},
+    {"jal", 0b010110},
+    {"jr", 0b010111},
+    {"addi", 0b011000},
+    {"vadd", 0b011001},
+    {"vsub", 0b011010},
+    {"vmul", 0b011011},
+    {"vsum", 0b011100},
+    {"vcmp", 0b011101},
+    {"setvl", 0b011110},
+    {"dcopy", 0b011111},
+    {"dfill", 0b100000},
+    {"dstat", 0b100001},
+    {"dwait", 0b100010},
     {"end",0b111111}
 };
 
@@ -66,43 +76,107 @@ const unordered_map<string, int> registerMap = {
     {"$fp", 0b11111},   // Frame pointer
 };
 
-unordered_map<string, vector<int>> dataMap;
-
-string encodeRType(string op, int rs, int rt, int rd, int shamt) {
-    int opcode = instructionMap.at(op);
-    int funct = instructionMap.at(op);
-    bitset<6> opcodeBits(opcode); // R-type has opcode 0
-    bitset<5> rsBits(rs);
-    bitset<5> rtBits(rt);
-    bitset<5> rdBits(rd);
-    bitset<5> shamtBits(shamt);
-    bitset<6> functBits(funct);
-    return (opcodeBits.to_string() + rsBits.to_string() + rtBits.to_string() + 
-            rdBits.to_string() + shamtBits.to_string() + functBits.to_string());
+uint32_t encodeRType(string op, int rs, int rt, int rd, int shamt) {
+    uint32_t opcode = instructionMap.at(op);
+    uint32_t funct = instructionMap.at(op);
+    return (opcode << 26) | (rs << 21) | (rt << 16) | (rd << 11) | (shamt << 6) | funct;
+}
+
+uint32_t encodeIType(string op, int rs, int rt, int immediate) {
+    uint32_t opcode = instructionMap.at(op);
+    return (opcode << 26) | (rs << 21) | (rt << 16) | (immediate & 0xFFFF);
 }
 
-string encodeIType(string op, int rs, int rt,string immediate) {
-    int opcode = instructionMap.at(op);
-    bitset<6> opcodeBits(opcode);
-    bitset<5> rsBits(rs);
-    bitset<5> rtBits(rt);
-    bitset<16> immBits;
+uint32_t encodeJType(string op, uint32_t address) {
+    uint32_t opcode = instructionMap.at(op);
+    return (opcode << 26) | (address & 0x3FFFFFF);
+}
 
+// Acrescenta uma instrução tipo I à representação intermediária. Se o
+// imediato for um nome (label ou variável) ele fica em symbol e vira uma
+// fixup quando o código for gerado.
+void emitIType(assemblyUnit &unit, string op, int rs, int rt, const string &immediate) {
+    irInstruction ir{op, rs, rt, 0, 0, ""};
     try {
-        immBits = bitset<16>(stoi(immediate));  // Convert to 16-bit binary
-    } // if it's a label just use the name 
+        ir.immediate = stoi(immediate);
+    }
     catch (invalid_argument&){
-        return (opcodeBits.to_string() + rsBits.to_string() + rtBits.to_string() + immediate);
+        ir.symbol = immediate;
+    }
+    unit.code.push_back(ir);
+}
+
+void defineSymbol(assemblyUnit &unit, const string &name, uint32_t value, uint8_t section) {
+    if (!unit.symbols.emplace(name, unit.object.symbols.size()).second) {
+        unit.log << "Error: Symbol \"" << name << "\" defined more than once." << endl;
+        return;
+    }
+    unit.object.AddSymbol(name, value, section);
+}
+
+// Resolve todas as fixups em uma única passada. Desvios para labels viram
+// deslocamentos relativos ao pc e acessos a variáveis viram offset($gp), então
+// o texto não depende do endereço de carga. O que sobra (label usado como
+// dado, nome indefinido) vira relocação absoluta aplicada pelo loader.
+void resolveFixups(assemblyUnit &unit) {
+    vector<uint32_t> &text = unit.object.text;
+    for (const fixup &ref : unit.fixups) {
+        auto symbol = unit.symbols.find(ref.symbol);
+        if (symbol == unit.symbols.end()) {
+            symbol = unit.symbols.emplace(ref.symbol, unit.object.AddSymbol(ref.symbol, 0, SEC_UNDEF)).first;
+        }
+        const objSymbol &def = unit.object.symbols[symbol->second];
+
+        if (ref.kind == FIX_PC && def.section == SEC_TEXT) {
+            int32_t delta = (int32_t)def.value - (int32_t)ref.offset;
+            if (delta < INT16_MIN || delta > INT16_MAX) {
+                unit.log << "Error: Branch to \"" << ref.symbol << "\" is out of range." << endl;
+            }
+            text[ref.offset] |= delta & 0xFFFF;
+        } else if (ref.kind == FIX_BASE && def.section == SEC_DATA) {
+            if (def.value > INT16_MAX) {
+                unit.log << "Error: Variable \"" << ref.symbol << "\" is out of $gp range." << endl;
+            }
+            text[ref.offset] |= (registerMap.at("$gp") << 21) | (def.value & 0xFFFF);
+        } else {
+            unit.object.relocs.push_back(objReloc{ref.offset, symbol->second, REL_ABS16});
+        }
+    }
+    unit.fixups.clear();
+}
+
+bool isRType(const string &op) {
+    return op == "add" || op == "sub" || op == "div" || op == "mult"
+        || op == "vadd" || op == "vsub" || op == "vmul" || op == "vsum" || op == "vcmp" || op == "setvl"
+        || op == "dcopy" || op == "dfill" || op == "dstat" || op == "dwait";
+}
+
+fixupKind fixupKindOf(const string &op) {
+    if (op == "j" || op == "jal" || op == "beq" || op == "bne" || op == "bgt" || op == "bgti" || op == "blt" || op == "blti") {
+        return FIX_PC;
+    }
+    if (op == "lw" || op == "sw" || op == "la" || op == "print") {
+        return FIX_BASE;
     }
-    
-    return (opcodeBits.to_string() + rsBits.to_string() + rtBits.to_string() + immBits.to_string());
+    return FIX_ABS;
 }
 
-string encodeJType(string op, string address) {
-    int opcode = instructionMap.at(op);
-    bitset<6> opcodeBits(opcode);
-    bitset<26> addrBits(address);
-    return (opcodeBits.to_string() + addrBits.to_string());
+// Gera as palavras do texto a partir da representação intermediária.
+void lowerUnit(assemblyUnit &unit) {
+    vector<uint32_t> &text = unit.object.text;
+    text.reserve(unit.code.size());
+    for (const irInstruction &ir : unit.code) {
+        if (ir.op.empty()) {
+            defineSymbol(unit, ir.symbol, text.size(), SEC_TEXT);
+        } else if (isRType(ir.op)) {
+            text.push_back(encodeRType(ir.op, ir.rs, ir.rt, ir.rd, 0));
+        } else {
+            if (!ir.symbol.empty()) {
+                unit.fixups.push_back(fixup{(uint32_t)text.size(), ir.symbol, fixupKindOf(ir.op)});
+            }
+            text.push_back(encodeIType(ir.op, ir.rs, ir.rt, ir.immediate));
+        }
+    }
 }
 
 string cleanRegisterString(const string& reg) {
@@ -112,23 +186,16 @@ string cleanRegisterString(const string& reg) {
     return cleaned;
 }
 
-int getRegisterCode(const string &reg) {   
+int getRegisterCode(const string &reg, ostream &log) {   
     string cleanedReg = cleanRegisterString(reg);
 
     if (registerMap.find(cleanedReg) != registerMap.end()) {
         return registerMap.at(cleanedReg);
     }
-    cerr << "Error: Invalid register \"" << cleanedReg << "\"" << endl;
+    log << "Error: Invalid register \"" << cleanedReg << "\"" << endl;
     return -1; 
 }
 
-string padInstruction(const string& instruction) {
-    if (instruction.length() < 32) {
-        return instruction + string(32 - instruction.length(), '#'); // Pad with '#'s
-    }
-    return instruction; 
-}
-
 string removeComments(const string &line) {
     size_t commentPos = line.find('#');
     if (commentPos != string::npos) {
@@ -137,18 +204,12 @@ string removeComments(const string &line) {
     return line;
 }
 
-void processAssemblyFile(const string &filePath, string &output) {
-    ifstream inFile(filePath);
+void processAssemblyFile(istream &inFile, assemblyUnit &unit) {
     string line;
     bool textSection = false;
     bool dataSection = false;
     bool insideLabel = false;
     int lineNum = 0;
-    
-    if (!inFile.is_open()) {
-        cerr << "Error opening file: " << filePath << endl;
-        return;
-    }
 
     while (getline(inFile, line)) {
 
@@ -182,15 +243,11 @@ void processAssemblyFile(const string &filePath, string &output) {
             if (colonPos != string::npos) {
                 
                 if(insideLabel){
-                    output += encodeIType("end", 0, 0, std::string(16, '0')); // Add end instruction
-                    output += "\n";               
+                    unit.code.push_back(irInstruction{"end"}); // Add end instruction
                 }
                 
                 string labelName = line.substr(0, colonPos);
-                if (labelName.length() > 16) {
-                    cerr << "Error: Label \"" << labelName << "\" exceeds the maximum length of 16 characters." << endl;
-                }                
-                output += labelName + ":\n"; 
+                unit.code.push_back(irInstruction{"", 0, 0, 0, 0, labelName});
                 insideLabel = true;
 
                 continue;
@@ -198,48 +255,78 @@ void processAssemblyFile(const string &filePath, string &output) {
             
             int rs = 0, rt = 0, rd = 0, immediate = 0;
             if (instructionMap.find(instruction) != instructionMap.end()) {
-                if (instruction == "add" || instruction == "sub" || instruction == "div" || instruction == "mult") {
+                if (instruction == "add" || instruction == "sub" || instruction == "div" || instruction == "mult"
+                    || instruction == "vadd" || instruction == "vsub" || instruction == "vmul" || instruction == "vcmp"
+                    || instruction == "dcopy" || instruction == "dfill") {
 
                     string rdStr, rsStr, rtStr;
                     iss >> rdStr >> rsStr >> rtStr; 
-                    rd = getRegisterCode(rdStr);
-                    rs = getRegisterCode(rsStr);
-                    rt = getRegisterCode(rtStr);
+                    rd = getRegisterCode(rdStr, unit.log);
+                    rs = getRegisterCode(rsStr, unit.log);
+                    rt = getRegisterCode(rtStr, unit.log);
 
                     if (rd != -1 && rs != -1 && rt != -1) {
-                        output += encodeRType(instruction, rs, rt, rd, 0);
-                        output += "\n";
+                        unit.code.push_back(irInstruction{instruction, rs, rt, rd});
                     }                
 
                 } else if (instruction == "beq" || instruction == "bne" || instruction == "bgt" || instruction == "blt" || instruction == "blti" || instruction == "bgti") {
                     string rsStr, rtStr, immediate;
                     iss >> rsStr >> rtStr >> immediate; 
-                    rs = getRegisterCode(rsStr);
-                    rt = getRegisterCode(rtStr);
+                    rs = getRegisterCode(rsStr, unit.log);
+                    rt = getRegisterCode(rtStr, unit.log);
 
                     if (rs != -1 && rt != -1) {
-                        output += padInstruction(encodeIType(instruction, rs, rt, immediate));
-                        output += "\n";
+                        emitIType(unit, instruction, rs, rt, immediate);
                     }                
 
-                } else if (instruction == "j") {
+                } else if (instruction == "addi") {
+                    string rtStr, rsStr, immediate;
+                    iss >> rtStr >> rsStr >> immediate;
+                    rt = getRegisterCode(rtStr, unit.log);
+                    rs = getRegisterCode(rsStr, unit.log);
+
+                    if (rs != -1 && rt != -1) {
+                        emitIType(unit, instruction, rs, rt, immediate);
+                    }
+
+                } else if (instruction == "vsum") {
+                    string rdStr, rsStr;
+                    iss >> rdStr >> rsStr;
+                    rd = getRegisterCode(rdStr, unit.log);
+                    rs = getRegisterCode(rsStr, unit.log);
+
+                    if (rd != -1 && rs != -1) {
+                        unit.code.push_back(irInstruction{instruction, rs, 0, rd});
+                    }
+
+                } else if (instruction == "dstat") {
+                    string rdStr;
+                    iss >> rdStr;
+                    rd = getRegisterCode(rdStr, unit.log);
+                    if (rd != -1) {
+                        unit.code.push_back(irInstruction{instruction, 0, 0, rd});
+                    }
+
+                } else if (instruction == "jr" || instruction == "setvl") {
+                    string rsStr;
+                    iss >> rsStr;
+                    rs = getRegisterCode(rsStr, unit.log);
+                    if (rs != -1) {
+                        unit.code.push_back(irInstruction{instruction, rs});
+                    }
+
+                } else if (instruction == "j" || instruction == "jal" || instruction == "sleep") {
                     string addrStr;
 
-                    try {
-                        iss >> addrStr; 
-                        output += padInstruction(encodeIType(instruction,0,0, addrStr));
-                        output += "\n";                    
-                    } catch (invalid_argument&) {
-                            cerr << "Error: Invalid address \"" << addrStr << "\" in instruction at line " << lineNum << endl;
-                    }                
+                    iss >> addrStr; 
+                    emitIType(unit, instruction, 0, 0, addrStr);                
                 } 
-                else if (instruction == "li" || instruction == "move" || instruction == "la") {
+                else if (instruction == "li" || instruction == "move" || instruction == "la" || instruction == "dread" || instruction == "dwrite") {
                     string rtStr, immediate;
                     iss >> rtStr >> immediate; 
-                    rt = getRegisterCode(rtStr);
+                    rt = getRegisterCode(rtStr, unit.log);
                     if (rt != -1) {
-                        output += padInstruction(encodeIType(instruction, 0, rt, immediate)); // rs is not used, set to 0
-                        output += "\n";
+                        emitIType(unit, instruction, 0, rt, immediate); // rs is not used, set to 0
                     }
 
                 }
@@ -247,17 +334,33 @@ void processAssemblyFile(const string &filePath, string &output) {
                 else if (instruction == "lw" || instruction == "sw") {
                     string rtStr, varName;
                     iss >> rtStr >> varName; 
-                    rt = getRegisterCode(rtStr);
-
-                    if (rs != -1 ) {
-                        if (dataMap.find(varName) != dataMap.end()) {
-                            output += padInstruction(encodeIType(instruction, 0, rt, varName));
-                            output += "\n";
+                    rt = getRegisterCode(rtStr, unit.log);
+
+                    size_t open = varName.find('(');
+                    if (rt != -1 && open != string::npos) {
+                        // offset($reg): endereço = registrador + offset com sinal
+                        size_t close = varName.find(')', open);
+                        string offset = open > 0 ? varName.substr(0, open) : "0";
+                        if (close == string::npos || offset == "-" || !all_of(offset.begin() + (offset[0] == '-'), offset.end(), ::isdigit)) {
+                            unit.log << "Error: Invalid memory operand \"" << varName << "\"" << endl;
                         } else {
-                            cerr << "Error: Variable \"" << varName << "\" not found in data section." << endl;
+                            rs = getRegisterCode(varName.substr(open + 1, close - open - 1), unit.log);
+                            if (rs != -1) {
+                                emitIType(unit, instruction, rs, rt, offset);
+                            }
+                        }
+                    }
+                    else if (rt != -1) {
+                        if (unit.dataMap.find(varName) != unit.dataMap.end()) {
+                            emitIType(unit, instruction, 0, rt, varName);
+                        } else {
+                            unit.log << "Error: Variable \"" << varName << "\" not found in data section." << endl;
                         }
                     }
                 }            
+                else if (instruction == "di" || instruction == "ei" || instruction == "dwait") {
+                    unit.code.push_back(irInstruction{instruction});
+                }
                 else if (instruction == "print") {
                     string arg;
                     iss >> arg;
@@ -265,13 +368,11 @@ void processAssemblyFile(const string &filePath, string &output) {
                     string cleanedReg = cleanRegisterString(arg);
                     
                     if (registerMap.find(cleanedReg) == registerMap.end()) {                        
-                        output += padInstruction(encodeIType("print", 0, 0, arg)); 
-                        output += "\n";
+                        emitIType(unit, "print", 0, 0, arg); 
                     }
                     else{
-                        int regCode = getRegisterCode(arg);
-                        output += encodeIType("print", 0, regCode, std::string(16,'0')); 
-                        output += "\n";
+                        int regCode = getRegisterCode(arg, unit.log);
+                        unit.code.push_back(irInstruction{"print", 0, regCode}); 
                     }
                 }            
             }
@@ -283,7 +384,7 @@ void processAssemblyFile(const string &filePath, string &output) {
                     }
                 }
                 if(exist)
-                    cerr << "Invalid instruction \"" << instruction << "\" at " << lineNum << endl;
+                    unit.log << "Invalid instruction \"" << instruction << "\" at " << lineNum << endl;
             }
         }
         else{
@@ -306,72 +407,169 @@ void processAssemblyFile(const string &filePath, string &output) {
                         try {
                             values.push_back(stoi(value));
                         } catch (invalid_argument&) {
-                            cerr << "Error: Invalid value for array \"" << varName << "\" at line " << lineNum << endl;
+                            unit.log << "Error: Invalid value for array \"" << varName << "\" at line " << lineNum << endl;
                             break;
                         }
                     }
-                    dataMap[varName] = values; 
+                    unit.dataMap[varName] = values; 
                 }
                 // normal value
                 else{
                      try {
                         int varValue = stoi(valueStr);
-                        dataMap[varName] = { varValue }; // save as single element vector
+                        unit.dataMap[varName] = { varValue }; // save as single element vector
                     } catch (invalid_argument&) {
-                        cerr << "Error: Invalid variable value for \"" << varName << "\" at line " << lineNum << endl;
+                        unit.log << "Error: Invalid variable value for \"" << varName << "\" at line " << lineNum << endl;
                     } catch (out_of_range&) {
-                        cerr << "Error: Variable value out of range for \"" << varName << "\" at line " << lineNum << endl;
+                        unit.log << "Error: Variable value out of range for \"" << varName << "\" at line " << lineNum << endl;
                     }                      
                 }
             } 
             else {
-                    cerr << "Error: Invalid variable definition in data section at line " << lineNum << endl;
+                    unit.log << "Error: Invalid variable definition in data section at line " << lineNum << endl;
                 }        
             }
                 
         lineNum++;
     }
-    inFile.close();
+    unit.code.push_back(irInstruction{"end"}); // Add end of program
 }
 
 
-void writeOutputFile(const string &output, const unordered_map<string, vector<int>> &dataMap, string fileName) {
-    fileName = fileName + ".bin";
-    fileName = "programs/" + fileName;
-    ofstream outFile(fileName);
-   
-    for (char bit : output) {
-        outFile << bit;
-    }
-    outFile << encodeIType("end", 0, 0, std::string(16, '0')); // Add end of program
-    outFile << endl;
-    
-    outFile << ".data:" << endl;
-    for (const auto &entry : dataMap) {
-        outFile << entry.first << ": ";
-
-        for (size_t i = 0; i < entry.second.size(); ++i) {
-            outFile << entry.second[i];
-            if (i < entry.second.size() - 1) {
-                outFile << ","; 
-            }
+void writeOutputFile(assemblyUnit &unit, const string &fileName) {
+    objectFile &object = unit.object;
+    lowerUnit(unit);
+
+    for (const auto &entry : unit.dataMap) {
+        defineSymbol(unit, entry.first, object.data.size(), SEC_DATA);
+        for (int value : entry.second) {
+            object.data.push_back(static_cast<uint32_t>(value));
         }
-        outFile << endl; 
-    }    
+    }
+    resolveFixups(unit);
+
+    writeObject(fileName, object);
 
     //cout << "Finished writing program to:" << fileName << endl;
+}
+
+// FNV-1a de 64 bits sobre a versão do assembler, as opções que mudam o
+// código gerado e o texto do fonte.
+uint64_t hashSource(const string &source, bool optimize) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    auto mix = [&hash](const string &bytes) {
+        for (unsigned char c : bytes) {
+            hash ^= c;
+            hash *= 0x100000001b3ULL;
+        }
+    };
+    mix(ASSEMBLER_VERSION);
+    mix(optimize ? "-O" : "");
+    mix(source);
+    return hash;
+}
+
+string cachePath(uint64_t key) {
+    char name[17];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return string(ASSEMBLER_CACHE_DIR) + "/" + name + ".bin";
+}
+
+struct assemblyPool {
+    vector<assemblyUnit> units;
+    vector<string> *files;
+    char **filePaths;
+    assemblyOptions options;
+    atomic<int> next;
+    atomic<int> hits;
+};
+
+// Monta um arquivo, ou copia o objeto do cache se o fonte já foi montado
+// antes por esta versão do assembler. Só montagens sem erro entram no cache.
+void assembleUnit(assemblyPool &pool, int i) {
+    assemblyUnit &unit = pool.units[i];
+    string filePath = pool.filePaths[i + 1];
+    string outPath = "programs/" + (*pool.files)[i + 1] + ".bin";
 
-    outFile.close();
+    ifstream inFile(filePath, ios::binary);
+    if (!inFile.is_open()) {
+        unit.log << "Error opening file: " << filePath << endl;
+        return;
+    }
+    string source((istreambuf_iterator<char>(inFile)), istreambuf_iterator<char>());
+
+    error_code error;
+    string cached = cachePath(hashSource(source, pool.options.optimize));
+    if (pool.options.useCache && filesystem::exists(cached, error)
+        && filesystem::copy_file(cached, outPath, filesystem::copy_options::overwrite_existing, error)) {
+        unit.cached = true;
+        pool.hits += 1;
+        return;
+    }
+
+    istringstream sourceStream(source);
+    processAssemblyFile(sourceStream, unit);
+    if (pool.options.optimize) {
+        optimizeCode(unit.code, unit.report);
+    }
+    writeOutputFile(unit, outPath);
+
+    if (pool.options.useCache && unit.log.str().empty()) {
+        // grava com outro nome e renomeia para outra execução nunca ler um objeto pela metade
+        string temp = cached + "." + to_string(getpid()) + "." + to_string(i);
+        filesystem::create_directories(ASSEMBLER_CACHE_DIR, error);
+        if (filesystem::copy_file(outPath, temp, filesystem::copy_options::overwrite_existing, error)) {
+            filesystem::rename(temp, cached, error);
+        }
+    }
 }
 
-int assembleFiles(int count, vector<string> files, char* filePaths[]) {
+// Cada thread do pool pega o próximo arquivo ainda não montado.
+void* assemblyWorker(void* arg) {
+    assemblyPool *pool = static_cast<assemblyPool*>(arg);
 
-    string output;
-    for(int i = 1; i < count; i++){
-        processAssemblyFile(filePaths[i], output);
-        writeOutputFile(output, dataMap,files[i]);
-        output.clear();
+    int i;
+    while ((i = pool->next.fetch_add(1)) < (int)pool->units.size()) {
+        assembleUnit(*pool, i);
+    }
+
+    return nullptr;
+}
+
+int assembleFiles(int count, vector<string> files, char* filePaths[], const assemblyOptions &options) {
+
+    assemblyPool pool;
+    pool.units.resize(max(0, count - 1));
+    pool.files = &files;
+    pool.filePaths = filePaths;
+    pool.options = options;
+    pool.next = 0;
+    pool.hits = 0;
+
+    int workers = min<int>(pool.units.size(), max(1u, thread::hardware_concurrency()));
+    vector<pthread_t> threads(workers);
+    for (int i = 0; i < workers; i++) {
+        if (pthread_create(&threads[i], nullptr, assemblyWorker, &pool) != 0) {
+            cerr << "Error creating assembler thread " << i << endl;
+            exit(1);
+        }
+    }
+    for (int i = 0; i < workers; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+
+    // mensagens na ordem dos arquivos, independente de qual thread montou
+    for (size_t i = 0; i < pool.units.size(); i++) {
+        const assemblyUnit &unit = pool.units[i];
+        cerr << unit.log.str();
+        if (options.optimize && options.report) {
+            if (unit.cached) {
+                cerr << "[" << files[i + 1] << "] -O: cached" << endl;
+            } else {
+                unit.report.Print(cerr, files[i + 1]);
+            }
+        }
     }
 
-    return 0;
+    return pool.hits;
 }
@@ -9,8 +9,54 @@
 #include <vector>
 #include <bitset>
 #include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <pthread.h>
+#include <thread>
+#include <unistd.h>
+
+#include"../loader/object.h"
+#include"./optimizer.h"
 
 using namespace std;
-int assembleFiles(int count, vector<string> files, char* filePaths[]);
+
+// Entra na chave do cache: mudar a codificação exige mudar a versão.
+#define ASSEMBLER_VERSION "8"
+#define ASSEMBLER_CACHE_DIR "programs/cache"
+
+enum fixupKind {
+    FIX_PC,         // desvio: deslocamento do label em relação à instrução
+    FIX_BASE,       // acesso a variável: offset($gp) dentro do segmento de dados
+    FIX_ABS         // endereço absoluto, corrigido pelo loader
+};
+
+// Referência a um símbolo ainda não resolvido na palavra offset do texto.
+struct fixup {
+    uint32_t offset;
+    string symbol;
+    fixupKind kind;
+};
+
+// Estado da montagem de um arquivo. Cada arquivo tem o seu, então arquivos
+// diferentes podem ser montados ao mesmo tempo.
+struct assemblyUnit {
+    unordered_map<string, vector<int>> dataMap;
+    vector<irInstruction> code;
+    objectFile object;
+    vector<fixup> fixups;
+    unordered_map<string, uint32_t> symbols;   // nome -> índice em object.symbols
+    ostringstream log;                          // erros, impressos na ordem dos arquivos
+    optimizerReport report;
+    bool cached = false;
+};
+
+struct assemblyOptions {
+    bool useCache = true;
+    bool optimize = false;      // -O
+    bool report = false;        // imprime o relatório do -O
+};
+
+// Retorna quantos arquivos vieram do cache.
+int assembleFiles(int count, vector<string> files, char* filePaths[], const assemblyOptions &options);
 
 #endif
@@ -0,0 +1,355 @@
+#include"./optimizer.h"
+
+#include <unordered_map>
+
+// Trecho que começa em um label (ou no início do programa) e vai até o
+// próximo label. Pode conter desvios condicionais no meio.
+struct irBlock {
+    string label;
+    vector<irInstruction> code;
+};
+
+static bool isBranch(const string &op) {
+    return op == "beq" || op == "bne" || op == "bgt" || op == "bgti" || op == "blt" || op == "blti";
+}
+
+static bool isTerminator(const string &op) {
+    return op == "j" || op == "jr" || op == "end";
+}
+
+static bool isControl(const string &op) {
+    return isBranch(op) || isTerminator(op);
+}
+
+static bool fallsThrough(const irBlock &block) {
+    return block.code.empty() || !isTerminator(block.code.back().op);
+}
+
+// Registrador escrito pela instrução, ou -1.
+static int definedRegister(const irInstruction &ir) {
+    if (ir.op == "add" || ir.op == "sub" || ir.op == "mult" || ir.op == "div" || ir.op == "vsum" || ir.op == "dstat") {
+        return ir.rd;
+    }
+    if (ir.op == "li" || ir.op == "la" || ir.op == "lw" || ir.op == "dread" || ir.op == "addi") {
+        return ir.rt;
+    }
+    if (ir.op == "jal") {
+        return 1;   // $ra
+    }
+    return -1;
+}
+
+static bool usesRegister(const irInstruction &ir, int reg) {
+    if (ir.op == "jal" || ir.op == "jr") {
+        // a função chamada e o chamador podem ler qualquer registrador
+        return true;
+    }
+    if (ir.op == "addi" || ir.op == "vsum" || ir.op == "setvl") {
+        return ir.rs == reg;
+    }
+    if (ir.op == "vadd" || ir.op == "vsub" || ir.op == "vmul" || ir.op == "vcmp" || ir.op == "dcopy" || ir.op == "dfill") {
+        // rd é o endereço do vetor resultado, não um registrador escrito
+        return ir.rs == reg || ir.rt == reg || ir.rd == reg;
+    }
+    if (ir.op == "add" || ir.op == "sub" || ir.op == "mult" || ir.op == "div" || isBranch(ir.op)) {
+        return ir.rs == reg || ir.rt == reg;
+    }
+    if (ir.op == "sw" || ir.op == "dwrite" || (ir.op == "print" && ir.symbol.empty())) {
+        return ir.rt == reg || (ir.rs == reg && ir.rs != 0);
+    }
+    if (ir.op == "lw" || ir.op == "la" || ir.op == "print") {
+        // offset(base)
+        return ir.rs == reg && ir.rs != 0;
+    }
+    return false;
+}
+
+static vector<irBlock> splitBlocks(const vector<irInstruction> &code, optimizerReport &report) {
+    vector<irBlock> blocks(1);
+    bool reachable = true;
+    for (const irInstruction &ir : code) {
+        if (ir.op.empty()) {
+            if (!blocks.back().label.empty() || !blocks.back().code.empty()) {
+                blocks.emplace_back();
+            }
+            blocks.back().label = ir.symbol;
+            reachable = true;
+        } else if (!reachable) {
+            report.deadCode += 1;
+        } else {
+            blocks.back().code.push_back(ir);
+            reachable = !isTerminator(ir.op);
+        }
+    }
+    return blocks;
+}
+
+static vector<irInstruction> joinBlocks(const vector<irBlock> &blocks) {
+    vector<irInstruction> code;
+    for (const irBlock &block : blocks) {
+        if (!block.label.empty()) {
+            code.push_back(irInstruction{"", 0, 0, 0, 0, block.label});
+        }
+        code.insert(code.end(), block.code.begin(), block.code.end());
+    }
+    return code;
+}
+
+static unordered_map<string, size_t> labelIndex(const vector<irBlock> &blocks) {
+    unordered_map<string, size_t> index;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (!blocks[i].label.empty()) {
+            index.emplace(blocks[i].label, i);
+        }
+    }
+    return index;
+}
+
+// Remove os blocos sem caminho a partir da entrada. Um label usado fora de
+// desvios (la de um label) é tratado como alcançável.
+static bool removeUnreachable(vector<irBlock> &blocks, optimizerReport &report) {
+    unordered_map<string, size_t> index = labelIndex(blocks);
+    vector<bool> reached(blocks.size(), false);
+    vector<size_t> work{0};
+
+    for (const irBlock &block : blocks) {
+        for (const irInstruction &ir : block.code) {
+            auto target = index.find(ir.symbol);
+            if (!isControl(ir.op) && target != index.end()) {
+                work.push_back(target->second);
+            }
+        }
+    }
+
+    while (!work.empty()) {
+        size_t i = work.back();
+        work.pop_back();
+        if (reached[i]) {
+            continue;
+        }
+        reached[i] = true;
+        for (const irInstruction &ir : blocks[i].code) {
+            auto target = index.find(ir.symbol);
+            if (isControl(ir.op) && target != index.end()) {
+                work.push_back(target->second);
+            }
+        }
+        if (fallsThrough(blocks[i]) && i + 1 < blocks.size()) {
+            work.push_back(i + 1);
+        }
+    }
+
+    vector<irBlock> kept;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (reached[i]) {
+            kept.push_back(move(blocks[i]));
+        } else {
+            report.deadCode += blocks[i].code.size();
+        }
+    }
+    bool changed = kept.size() != blocks.size();
+    blocks = move(kept);
+    return changed;
+}
+
+// Propaga as constantes de li dentro do bloco e troca add/sub de duas
+// constantes por um li. O li carrega o imediato sem sinal, então só
+// resultados entre 0 e 0xFFFF são dobrados.
+static bool foldConstants(irBlock &block, optimizerReport &report) {
+    unordered_map<int, int64_t> known;
+    bool changed = false;
+
+    for (irInstruction &ir : block.code) {
+        if ((ir.op == "add" || ir.op == "sub") && known.count(ir.rs) && known.count(ir.rt)) {
+            int64_t value = ir.op == "add" ? known[ir.rs] + known[ir.rt] : known[ir.rs] - known[ir.rt];
+            if (value >= 0 && value <= 0xFFFF) {
+                ir = irInstruction{"li", 0, ir.rd, 0, (int)value, ""};
+                report.folded += 1;
+                changed = true;
+            }
+        }
+
+        int reg = definedRegister(ir);
+        if (ir.op == "jal") {
+            // a função chamada pode escrever qualquer registrador
+            known.clear();
+        } else if (ir.op == "li" && ir.symbol.empty()) {
+            known[reg] = ir.immediate & 0xFFFF;
+        } else if (reg >= 0) {
+            known.erase(reg);
+        }
+    }
+    return changed;
+}
+
+// Remove li/la cujo valor é sobrescrito antes de ser lido. Um desvio no meio
+// do caminho mantém o valor, que pode ser lido no destino.
+static bool removeDeadLoads(irBlock &block, optimizerReport &report) {
+    vector<irInstruction> &code = block.code;
+    bool changed = false;
+
+    for (size_t i = 0; i < code.size(); i++) {
+        if (code[i].op != "li" && code[i].op != "la") {
+            continue;
+        }
+        int reg = code[i].rt;
+        bool dead = false;
+        for (size_t j = i + 1; j < code.size(); j++) {
+            if (code[j].op == "end") {
+                dead = true;
+                break;
+            }
+            if (usesRegister(code[j], reg) || isControl(code[j].op)) {
+                break;
+            }
+            if (definedRegister(code[j]) == reg) {
+                dead = true;
+                break;
+            }
+        }
+        if (dead) {
+            code.erase(code.begin() + i);
+            report.deadLoads += 1;
+            changed = true;
+            i -= 1;
+        }
+    }
+    return changed;
+}
+
+// Agrupa os blocos em cadeias ligadas por fall-through e coloca logo depois
+// de cada cadeia terminada em "j L" a cadeia que começa em L, para o salto
+// virar fall-through. As demais ficam na ordem original.
+static bool layoutBlocks(vector<irBlock> &blocks, optimizerReport &report) {
+    vector<vector<size_t>> chains;
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (i == 0 || !fallsThrough(blocks[i - 1])) {
+            chains.emplace_back();
+        }
+        chains.back().push_back(i);
+    }
+
+    unordered_map<string, size_t> chainOf;
+    for (size_t c = 1; c < chains.size(); c++) {
+        const string &head = blocks[chains[c].front()].label;
+        if (!head.empty()) {
+            chainOf.emplace(head, c);
+        }
+    }
+
+    vector<bool> placed(chains.size(), false);
+    vector<size_t> order{0};
+    placed[0] = true;
+    size_t nextInOrder = 1;
+    bool changed = false;
+
+    while (order.size() < chains.size()) {
+        const vector<irInstruction> &last = blocks[chains[order.back()].back()].code;
+        size_t chosen = chains.size();
+        auto unplaced = [&](const string &label) {
+            auto target = chainOf.find(label);
+            return target != chainOf.end() && !placed[target->second] ? target->second : chains.size();
+        };
+        if (!last.empty() && last.back().op == "j") {
+            // em "bxx L1; j L2" o corpo do laço costuma ser L1: colocá-lo em
+            // seguida deixa o caminho quente em fall-through após a inversão
+            if (last.size() >= 2 && isBranch(last[last.size() - 2].op)) {
+                chosen = unplaced(last[last.size() - 2].symbol);
+            }
+            if (chosen == chains.size()) {
+                chosen = unplaced(last.back().symbol);
+            }
+        }
+        while (nextInOrder < chains.size() && placed[nextInOrder]) {
+            nextInOrder += 1;
+        }
+        if (chosen == chains.size()) {
+            chosen = nextInOrder;
+        } else if (chosen != nextInOrder) {
+            report.blocksMoved += chains[chosen].size();
+            changed = true;
+        }
+        placed[chosen] = true;
+        order.push_back(chosen);
+    }
+
+    if (changed) {
+        vector<irBlock> laidOut;
+        for (size_t c : order) {
+            for (size_t i : chains[c]) {
+                laidOut.push_back(move(blocks[i]));
+            }
+        }
+        blocks = move(laidOut);
+    }
+    return changed;
+}
+
+// "j L" seguido do bloco L vira fall-through. "bxx L1; j L2" seguido do
+// bloco L1 vira o desvio inverso para L2.
+static bool simplifyJumps(vector<irBlock> &blocks, optimizerReport &report) {
+    static const unordered_map<string, string> inverse = {
+        {"blt", "bgti"}, {"bgti", "blt"}, {"bgt", "blti"}, {"blti", "bgt"}
+    };
+    bool changed = false;
+
+    for (size_t i = 0; i + 1 < blocks.size(); i++) {
+        vector<irInstruction> &code = blocks[i].code;
+        const string &next = blocks[i + 1].label;
+        if (code.empty() || code.back().op != "j" || next.empty()) {
+            continue;
+        }
+        if (code.back().symbol == next) {
+            code.pop_back();
+            report.jumpsRemoved += 1;
+            changed = true;
+            continue;
+        }
+        if (code.size() >= 2) {
+            irInstruction &branch = code[code.size() - 2];
+            auto inv = inverse.find(branch.op);
+            if (branch.symbol == next && inv != inverse.end()) {
+                branch.op = inv->second;
+                branch.symbol = code.back().symbol;
+                code.pop_back();
+                report.branchesInverted += 1;
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+static int countInstructions(const vector<irInstruction> &code) {
+    int count = 0;
+    for (const irInstruction &ir : code) {
+        count += !ir.op.empty();
+    }
+    return count;
+}
+
+void optimizeCode(vector<irInstruction> &code, optimizerReport &report) {
+    report.before = countInstructions(code);
+    vector<irBlock> blocks = splitBlocks(code, report);
+
+    bool changed = true;
+    for (int pass = 0; changed && pass < 16; pass++) {
+        changed = removeUnreachable(blocks, report);
+        for (irBlock &block : blocks) {
+            changed |= foldConstants(block, report);
+            changed |= removeDeadLoads(block, report);
+        }
+        changed |= layoutBlocks(blocks, report);
+        changed |= simplifyJumps(blocks, report);
+    }
+
+    code = joinBlocks(blocks);
+    report.after = countInstructions(code);
+}
+
+void optimizerReport::Print(ostream &out, const string &name) const {
+    out << "[" << name << "] -O: " << before << " -> " << after << " instructions"
+        << " (dead " << deadCode << ", jumps " << jumpsRemoved << ", folded " << folded
+        << ", dead loads " << deadLoads << ", inverted " << branchesInverted
+        << ", moved " << blocksMoved << ")" << endl;
+}
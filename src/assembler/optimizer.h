@@ -0,0 +1,35 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Instrução da representação intermediária. A definição de um label é uma
+// entrada com op vazio e o nome do label em symbol.
+struct irInstruction {
+    string op;
+    int rs = 0, rt = 0, rd = 0;
+    int immediate = 0;
+    string symbol = ""; // label ou variável usado como imediato
+};
+
+struct optimizerReport {
+    int before = 0;             // instruções antes das passadas
+    int after = 0;
+    int deadCode = 0;           // inalcançáveis (após j/end ou blocos sem caminho)
+    int jumpsRemoved = 0;       // j para a instrução seguinte
+    int folded = 0;             // add/sub de constantes trocados por li
+    int deadLoads = 0;          // li/la sobrescritos antes de serem lidos
+    int branchesInverted = 0;   // desvio sobre um j trocado pelo desvio inverso
+    int blocksMoved = 0;        // blocos colocados logo após o j que os alcança
+
+    void Print(ostream &out, const string &name) const;
+};
+
+// Passadas do -O sobre o código de um arquivo, repetidas até não haver mudança.
+void optimizeCode(vector<irInstruction> &code, optimizerReport &report);
+
+#endif
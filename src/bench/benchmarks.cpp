@@ -0,0 +1,243 @@
+// Microbenchmarks dos caminhos quentes do simulador (Google Benchmark). Rodar a
+// partir da raiz do repositório: o loader lê de programs/ e os programas vêm de
+// testes/.
+#include "../cpu/CONTROL_UNIT.h"
+#include "../cpu/ALU.h"
+#include "../memory/MAINMEMORY.h"
+#include "../loader/loader.h"
+#include "../assembler/assembler.h"
+#include "../sim/SCHEDULER.h"
+#include "../PCB.h"
+
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+
+#define BENCH_PROGRAM "testes/latency.asm"
+#define BENCH_PROGRAM_NAME "latency"
+
+// Monta o programa de teste uma vez (pelo cache do assembler) para o loader.
+static void assembleProgram(){
+    static const bool assembled = []{
+        vector<string> files{"bench", BENCH_PROGRAM_NAME};
+        char name[] = "bench";
+        char path[] = BENCH_PROGRAM;
+        char* paths[] = {name, path};
+        assembleFiles(2, files, paths, assemblyOptions{});
+        return true;
+    }();
+    (void)assembled;
+}
+
+// MainMemory não tem destrutor.
+static void releaseMemory(MainMemory &ram){
+    for(int k = 0; k < ram.NumOfi; k++){
+        free(ram.words[k]);
+    }
+    free(ram.words);
+    ram.words = nullptr;
+}
+
+// Palavras do segmento de texto do programa de teste: a mistura de instruções
+// que o Fetch realmente vê.
+static const vector<uint32_t>& programWords(){
+    static const vector<uint32_t> words = []{
+        assembleProgram();
+        MainMemory ram(2048, 2048);
+        programLayout layout;
+        loadProgram(BENCH_PROGRAM_NAME, ram, 0, layout);
+        vector<uint32_t> words;
+        for(uint32_t address = 0; address < layout.data; address++){
+            words.push_back(ram.ReadMem(address));
+        }
+        releaseMemory(ram);
+        return words;
+    }();
+    return words;
+}
+
+static void BM_Identificacao_instrucao(benchmark::State &state){
+    const vector<uint32_t> &words = programWords();
+    Control_Unit UC;
+    REGISTER_BANK registers;
+    size_t i = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(UC.Identificacao_instrucao(words[i], registers));
+        i = i + 1 == words.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Identificacao_instrucao);
+
+// Os extratores de campo usados pelo Decode, um por iteração de cada.
+static void BM_Get_extractors(benchmark::State &state){
+    const vector<uint32_t> &words = programWords();
+    Control_Unit UC;
+    size_t i = 0;
+    for(auto _ : state){
+        const uint32_t word = words[i];
+        benchmark::DoNotOptimize(UC.Get_source_Register(word));
+        benchmark::DoNotOptimize(UC.Get_target_Register(word));
+        benchmark::DoNotOptimize(UC.Get_destination_Register(word));
+        benchmark::DoNotOptimize(UC.Get_immediate(word));
+        benchmark::DoNotOptimize(UC.Pick_Code_Register_Load(word));
+        i = i + 1 == words.size() ? 0 : i + 1;
+    }
+    state.SetItemsProcessed(state.iterations() * 5);
+}
+BENCHMARK(BM_Get_extractors);
+
+static const char* benchRegisters[] = {"t0", "s1", "a0", "sp", "ra", "v0", "t7", "gp"};
+
+// Leitura pelo mapa de nomes, como o Execute faz, e direta no REGISTER.
+static void BM_RegisterBank_ReadByName(benchmark::State &state){
+    REGISTER_BANK registers;
+    size_t i = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(registers.acessoLeituraRegistradores[benchRegisters[i]]());
+        i = (i + 1) & 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegisterBank_ReadByName);
+
+static void BM_RegisterBank_WriteByName(benchmark::State &state){
+    REGISTER_BANK registers;
+    size_t i = 0;
+    uint32_t value = 0;
+    for(auto _ : state){
+        registers.acessoEscritaRegistradores[benchRegisters[i]](value++);
+        i = (i + 1) & 7;
+    }
+    benchmark::DoNotOptimize(registers.t0.read());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegisterBank_WriteByName);
+
+static void BM_RegisterBank_Direct(benchmark::State &state){
+    REGISTER_BANK registers;
+    uint32_t value = 0;
+    for(auto _ : state){
+        registers.t0.write(value++);
+        benchmark::DoNotOptimize(registers.t0.read());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RegisterBank_Direct);
+
+static void BM_ALU_calculate(benchmark::State &state){
+    static const operation ops[] = {ADD, SUB, MUL, DIV, BEQ, BNE, BLT, BGT};
+    ALU alu;
+    uint32_t a = 60000, b = 7;
+    size_t i = 0;
+    for(auto _ : state){
+        alu.A = a++;
+        alu.B = b;
+        alu.op = ops[i];
+        alu.calculate();
+        benchmark::DoNotOptimize(alu.result);
+        i = (i + 1) & 7;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ALU_calculate);
+
+// Argumento: palavras percorridas em sequência, para ver o efeito da cache do host.
+static void BM_MainMemory_ReadMem(benchmark::State &state){
+    static MainMemory ram(2048, 2048);
+    const uint32_t footprint = state.range(0);
+    uint32_t address = 0;
+    for(auto _ : state){
+        benchmark::DoNotOptimize(ram.ReadMem(address));
+        address = address + 1 == footprint ? 0 : address + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MainMemory_ReadMem)->Arg(1 << 10)->Arg(1 << 16)->Arg(2048 * 2048);
+
+static void BM_MainMemory_WriteMem(benchmark::State &state){
+    static MainMemory ram(2048, 2048);
+    const uint32_t footprint = state.range(0);
+    uint32_t address = 0;
+    for(auto _ : state){
+        ram.WriteMem(address, address);
+        address = address + 1 == footprint ? 0 : address + 1;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MainMemory_WriteMem)->Arg(1 << 10)->Arg(1 << 16)->Arg(2048 * 2048);
+
+// A liberação fica fora da medida.
+static void BM_MainMemory_Construct(benchmark::State &state){
+    for(auto _ : state){
+        MainMemory ram(2048, 2048);
+        benchmark::DoNotOptimize(ram.words);
+        state.PauseTiming();
+        releaseMemory(ram);
+        state.ResumeTiming();
+    }
+}
+BENCHMARK(BM_MainMemory_Construct)->Unit(benchmark::kMillisecond);
+
+static void BM_loadProgram(benchmark::State &state){
+    assembleProgram();
+    static MainMemory ram(2048, 2048);
+    for(auto _ : state){
+        programLayout layout;
+        benchmark::DoNotOptimize(loadProgram(BENCH_PROGRAM_NAME, ram, 0, layout));
+    }
+}
+BENCHMARK(BM_loadProgram)->Unit(benchmark::kMicrosecond);
+
+// Uma rodada de coreDispatch: escolhe o processo, roda um quantum de
+// state.range(0) ciclos no núcleo em ordem e o devolve ao escalonador. O
+// processo volta ao início do programa fora da medida.
+static void BM_coreDispatch(benchmark::State &state){
+    assembleProgram();
+    static MainMemory ram(2048, 2048);
+    programLayout layout;
+    const uint32_t end = loadProgram(BENCH_PROGRAM_NAME, ram, 0, layout);
+
+    SECONDARY_MEMORY disk(64);
+    IO_SUBSYSTEM io(disk, 64);
+    SIM_CLOCK clock(1);
+    PROFILED_MUTEX queueLock("queueLock");
+    vector<unique_ptr<PCB>> processes;
+    scheduleInfo info;
+    info.ram = &ram;
+    info.processes = &processes;
+    info.queueLock = &queueLock;
+    info.io = &io;
+    info.clock = &clock;
+    info.interrupts.push_back(make_unique<INTERRUPT_CONTROLLER>(0));
+    info.returnStacks.resize(1);
+    info.executionUnits.resize(1);
+    info.pipelineCounters.resize(1);
+    info.shutdown = false;
+
+    auto pcb = make_unique<PCB>();
+    pcb->baseAddr = 0;
+    pcb->finalAddr = end;
+    pcb->quantum = state.range(0);
+    pcb->id = 1;
+    pcb->regBank.sr.write(SR_DEFAULT);
+    pcb->regBank.gp.write(layout.data);
+    pcb->regBank.sp.write(layout.stackTop);
+    pcb->regBank.fp.write(layout.stackTop);
+    PCB &process = *pcb;
+    processes.push_back(move(pcb));
+
+    for(auto _ : state){
+        state.PauseTiming();
+        process.state = State::Ready;
+        process.readyTime = 0;
+        process.regBank.pc.value = 0;
+        uint64_t localTime = 0;
+        state.ResumeTiming();
+
+        benchmark::DoNotOptimize(coreDispatch(&info, 0, localTime));
+    }
+    state.counters["cycles"] = benchmark::Counter(info.pipelineCounters[0].Cycles(), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_coreDispatch)->Arg(10)->Arg(100)->Unit(benchmark::kMicrosecond);
+
+BENCHMARK_MAIN();
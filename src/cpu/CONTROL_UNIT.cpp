@@ -1,52 +1,150 @@
 #include "CONTROL_UNIT.h"
 #include "../PCB.h"
+#include <algorithm>
 #include <bitset>
 #include <memory>
 #include <string>
 #include <vector>
 
 
-void* Core(MainMemory &ram, PCB &process, vector<unique_ptr<ioRequest>>* ioRequests, bool &printLock){
+// Soma os contadores de um quantum nos do núcleo e do processo, com o motivo
+// da saída do núcleo.
+static void Retire_Quantum(PIPELINE_COUNTERS &quantum, const ControlContext &context, PIPELINE_COUNTERS &counters){
+    const PCB &process = context.process;
+    quantum.quanta = 1;
+    if(context.endProgram){
+        quantum.finished = 1;
+    }else if(process.waitingIO || process.waitingDMA || process.waitingIOSpace >= 0){
+        quantum.ioBlockExits = 1;
+    }else{
+        quantum.timerExits = 1;
+    }
+    counters.Merge(quantum);
+    context.process.pipeline.Merge(quantum);
+}
+
+coreResources Core_Resources(scheduleInfo &info, int core){
+    EXECUTION_UNITS &units = info.executionUnits[core];
+    return coreResources{*info.ram, *info.io, *info.interrupts[core], &info.returnStacks[core * units.contexts], units,
+        info.pipelineCounters[core], info.profiler, info.trace, info.host};
+}
+
+void* Core(coreResources &core, PCB &process, uint64_t &time){
     // load register and state from PCB
     auto &registers = process.regBank;
+    INTERRUPT_CONTROLLER &irq = core.irq;
+    EXECUTION_UNITS &units = core.units;
+    PROFILER *profiler = core.profiler;
+    TRACE_RECORDER *trace = core.trace;
+    HOST_COUNTERS *host = core.host;
     
     Control_Unit UC;
     Instruction_Data data;
     
-    int clock = 0;
     int counterForEnd = 5;
     int counter = 0;
     bool endProgram = false;
     bool endExecution = false;
     
-    ControlContext context{registers, ram, *ioRequests, printLock, process, counter, counterForEnd, endProgram, endExecution};
+    ControlContext context{registers, core.ram, core.io, time, irq, core.ras[0], units, process, counter, counterForEnd, endProgram, endExecution, profiler, trace, host};
+    const uint64_t start = time;
+    PIPELINE_COUNTERS quantum;
+    uint32_t sampledPc = registers.pc.read();     // última instrução que passou pelo EX
+    if(profiler){
+        profiler->Resume(irq.core, time);
+    }
+    if(host){
+        host->Begin(irq.core, HOST_CORE);
+    }
     
-    while(context.counterForEnd > 0){
-        if(context.counter >= 4 && context.counterForEnd >= 1){
-            //chamar a instrução de write back
-            UC.Write_Back(UC.data[context.counter - 4],context);
-        }
+    // o fim do quantum chega como interrupção do timer
+    irq.ArmTimer(time + process.quantum);
+
+    if(units.outOfOrder){
+        TOMASULO engine(units, time);
+        UC.Run_Timed(context, engine, quantum);
+    }else if(units.issueWidth > 1){
+        SUPERSCALAR engine(units, time);
+        UC.Run_Timed(context, engine, quantum);
+    }
+
+    while(!units.Timed() && context.counterForEnd > 0){
+        // o ciclo conta como base se uma instrução passa pelo EX; senão é
+        // bolha do pipeline enchendo ou esvaziando
+        const bool draining = context.endExecution;
+        bool executed = false;
+        uint64_t before;
+
+        // write back: os registradores já são escritos no Execute/Memory_Acess e o
+        // store no Memory_Acess, então o estágio é só o último dos cinco ciclos
+        // contados por counterForEnd
         if(context.counter >= 3 && context.counterForEnd >= 2){
             //chamar a instrução de memory_acess da unidade de controle
+            hostSample sample(host, irq.core, HOST_MEMORY);
+            before = context.time;
             UC.Memory_Acess(UC.data[context.counter - 3],context);
+            quantum.Add(CPI_MEMORY, context.time - before);
         }
         if(context.counter >= 2 && context.counterForEnd >= 3){
             //chamar a instrução de execução da unidade de controle
-            UC.Execute(UC.data[context.counter - 2], context);
+            executed = !UC.data[context.counter - 2].op.empty();
+            if(executed){
+                quantum.refilling = false;
+                sampledPc = UC.data[context.counter - 2].address;
+            }
+            // um desvio tomado zera context.counter
+            hostSample sample(host, irq.core, HOST_EXECUTE);
+            Instruction_Data &executing = UC.data[context.counter - 2];
+            scheduledOp traced;
+            if(trace && executed){
+                UC.Describe_Operation(executing, context, traced);
+            }
+            before = context.time;
+            UC.Execute(executing, context);
+            quantum.Add(CPI_EXECUTE, context.time - before);
+            if(trace && executed){
+                UC.Trace_Instruction(executing, context, traced);
+            }
+            if(context.counter == 0){
+                quantum.Flush();
+            }
         }
         if(context.counter >= 1 && context.counterForEnd >= 4){
             //chamar a instrução de decode da unidade de controle
+            hostSample sample(host, irq.core, HOST_DECODE);
             UC.Decode(context.registers,UC.data[context.counter-1]);
         }
         if(context.counter >= 0 && context.counterForEnd == 5){
             //chamar a instrução de fetch da unidade de controle
+            hostSample sample(host, irq.core, HOST_FETCH);
             UC.data.push_back(data);
-            UC.Fetch(context);
+            UC.data[context.counter].address = context.registers.pc.read();
+            UC.Fetch(UC.data[context.counter], context);
         }
         context.counter += 1;
-        clock += 1;
+        context.time += 1;
+        if(executed){
+            quantum.instructions += 1;
+            quantum.Add(CPI_BASE, 1);
+        }else{
+            quantum.Add(draining ? CPI_DRAIN : quantum.refilling ? CPI_BRANCH : CPI_FETCH, 1);
+        }
+        if(profiler){
+            profiler->Tick(irq.core, process.id, sampledPc, context.time);
+        }
 
-        if(clock >= process.quantum || context.endProgram == true){
+        context.irq.Tick(context.time);
+        if(context.irq.pendingMask != 0){
+            hostSample sample(host, irq.core, HOST_INTERRUPT);
+            before = context.time;
+            UC.Handle_Interrupts(context);
+            quantum.Add(CPI_INTERRUPT, context.time - before);
+            if(profiler){
+                profiler->Tick(irq.core, process.id, PROFILE_INTERRUPT, context.time);
+            }
+        }
+
+        if(context.endProgram == true){
             context.endExecution = true;
         }
         
@@ -55,32 +153,171 @@ void* Core(MainMemory &ram, PCB &process, vector<unique_ptr<ioRequest>>* ioReque
         }
     }
 
+    irq.DisarmTimer();
+    units.cycles += time - start;
+    if(host){
+        host->EndCore(irq.core, units.ModeName(), quantum.instructions);
+    }
+    Retire_Quantum(quantum, context, core.counters);
+
     if(context.endProgram){
         context.process.state = State::Finished;
+        context.process.finishTime = time;
     }    
     
     return nullptr;
 }
 
+struct hardwareContext {
+    int counter = 0;
+    int counterForEnd = 5;
+    bool endProgram = false;
+    bool endExecution = false;
+};
+
+// SMT: cada processo ocupa um contexto de hardware do núcleo fora de ordem
+// (ras[i] é a pilha de retorno do contexto i). A cada instrução busca o
+// contexto que pode buscar mais cedo; nos empates decide a política de busca,
+// então os ciclos em que um contexto espera um desvio ou uma operação longa
+// ficam para os outros. O quantum é do núcleo: o timer devolve todos os
+// processos ao escalonador, e um contexto que bloqueia ou termina sai sem
+// parar os demais.
+void* Core_SMT(coreResources &core, const vector<PCB*> &processes, uint64_t &time){
+    const size_t count = processes.size();
+    INTERRUPT_CONTROLLER &irq = core.irq;
+    EXECUTION_UNITS &units = core.units;
+    PROFILER *profiler = core.profiler;
+    HOST_COUNTERS *host = core.host;
+    Control_Unit UC;
+    TOMASULO engine(units, time, count);
 
-using namespace std;
+    vector<hardwareContext> state(count);
+    vector<PIPELINE_COUNTERS> quanta(count);   // ciclos atribuídos ao contexto que os fez avançar
+    vector<ControlContext> contexts;
+    contexts.reserve(count);
+    for(size_t i = 0; i < count; i++){
+        hardwareContext &hw = state[i];
+        contexts.push_back(ControlContext{processes[i]->regBank, core.ram, core.io, time, irq, core.ras[i], units, *processes[i],
+            hw.counter, hw.counterForEnd, hw.endProgram, hw.endExecution, profiler, core.trace, host});
+    }
+    const uint64_t start = time;
+    if(profiler){
+        profiler->Resume(irq.core, time);
+    }
+    if(host){
+        host->Begin(irq.core, HOST_CORE);
+    }
+
+    irq.ArmTimer(time + processes.front()->quantum);
 
-uint32_t ConvertToDecimalValue(uint32_t value){
-    string bin_str = to_string(value);
-        uint32_t decimal_value = 0;       
-        int len = bin_str.length();
-        for (int i = 0; i < len; ++i) {
-        if (bin_str[i] == '1') {
-            decimal_value += std::pow(2, len - 1 - i);
+    vector<int> active;
+    for(size_t i = 0; i < count; i++){
+        active.push_back(i);
+    }
+    size_t turn = 0;
+    while(!active.empty()){
+        // o primeiro a poder buscar; nos empates, a vez (rr) ou o com menos
+        // instruções em voo (icount)
+        size_t chosen = turn % active.size();
+        uint64_t fetch = engine.NextFetch(active[chosen]);
+        for(size_t k = 1; k < active.size(); k++){
+            size_t candidate = (turn + k) % active.size();
+            uint64_t next = engine.NextFetch(active[candidate]);
+            if(next < fetch || (next == fetch && units.policy == FETCH_ICOUNT
+                && engine.InFlight(active[candidate], next) < engine.InFlight(active[chosen], fetch))){
+                chosen = candidate;
+                fetch = next;
             }
         }
-    return decimal_value;
+        turn = chosen + 1;
+
+        const int thread = active[chosen];
+        ControlContext &context = contexts[thread];
+        irq.Tick(fetch);
+        if(irq.pendingMask != 0){
+            hostSample sample(host, irq.core, HOST_INTERRUPT);
+            const uint64_t before = time;
+            UC.Handle_Interrupts(context);
+            quanta[thread].Add(CPI_INTERRUPT, time - before);
+            if(profiler){
+                profiler->Tick(irq.core, context.process.id, PROFILE_INTERRUPT, time);
+            }
+            engine.Stall(time);
+            if(context.endExecution){
+                // fim do quantum: o que já foi buscado termina e todos saem
+                for(int other : active){
+                    contexts[other].endExecution = true;
+                }
+                break;
+            }
+        }
+
+        UC.Step_Timed(context, engine, thread, quanta[thread]);
+        if(context.endExecution){
+            if(context.endProgram){
+                context.process.state = State::Finished;
+                context.process.finishTime = time;
+            }
+            active.erase(active.begin() + chosen);
+        }
+    }
+
+    irq.DisarmTimer();
+    units.cycles += time - start;
+    if(host){
+        uint64_t instructions = 0;
+        for(const PIPELINE_COUNTERS &quantum : quanta){
+            instructions += quantum.instructions;
+        }
+        host->EndCore(irq.core, units.ModeName(), instructions);
+    }
+    for(size_t i = 0; i < count; i++){
+        Retire_Quantum(quanta[i], contexts[i], core.counters);
+    }
+
+    return nullptr;
+}
+
+// Atende as interrupções de dispositivo de um núcleo sem processo, usando o
+// banco de registradores do kernel do controlador.
+void Idle_Interrupts(INTERRUPT_CONTROLLER &irq, IO_SUBSYSTEM &io, uint64_t &time){
+    REGISTER_BANK &registers = irq.kernelRegisters;
+    interruptEntry entry;
+    while(irq.Next(registers, time, entry)){
+        if(entry.line != IRQ_TIMER){
+            io.HandleCompletion(entry.request, time);
+        }
+        time += IRQ_HANDLER_CYCLES;
+        irq.Return(registers, IRQ_HANDLER_CYCLES);
+    }
+}
+
+
+using namespace std;
+
+uint32_t ConvertToDecimalValue(const string &bits){
+    return stoul(bits, nullptr, 2);
+}
+
+// Imediato de 16 bits com sinal: deslocamento relativo ao pc ou a um registrador base.
+int32_t SignedImmediate(const string &bits){
+    return (int16_t)ConvertToDecimalValue(bits);
+}
+
+// Endereço efetivo offset(base). Com base $zero o imediato é o endereço absoluto.
+uint32_t Control_Unit::Effective_Address(REGISTER_BANK &registers, Instruction_Data &data){
+    if(data.source_register.empty() || data.source_register == "00000"){
+        return ConvertToDecimalValue(data.addressRAMResult);
+    }
+    string base = this->map.mp[data.source_register];
+    return registers.acessoLeituraRegistradores[base]() + SignedImmediate(data.addressRAMResult);
 }
 
 //PIPELINE
 
-void Control_Unit::Fetch(ControlContext &context){
+void Control_Unit::Fetch(Instruction_Data &data, ControlContext &context){
     const uint32_t instruction = context.registers.ir.read();
+    data.predicted = false;
     
     //registers.ir.write(ram.ReadMem(registers.mar.read()));
     if(instruction == 0b11111100000000000000000000000000)
@@ -96,6 +333,20 @@ void Control_Unit::Fetch(ControlContext &context){
     context.registers.ir.write(context.ram.ReadMem(context.registers.mar.read()));
     //cout << "IR: " << bitset<32>(registers.ir.read()) << endl;
     context.registers.pc.write(context.registers.pc.value += 1);//incrementando o pc 
+
+    // pré-decodificação: jal já desvia aqui e jr $ra segue a pilha de retorno,
+    // então chamadas e retornos previstos não esvaziam o pipeline no Execute
+    const uint32_t fetched = context.registers.ir.read();
+    if((fetched >> 26) == jalOpcode){
+        context.ras.Push(data.address + 1);
+        context.registers.pc.write(data.address + (int16_t)(fetched & 0xFFFF));
+    }else if((fetched >> 26) == jrOpcode && this->map.mp[Get_source_Register(fetched)] == "ra"){
+        data.predicted = context.ras.Pop(data.predictedTarget);
+        if(data.predicted){
+            context.registers.pc.write(data.predictedTarget);
+        }
+    }
+    data.ras = context.ras.Save();
 }
 
 void Control_Unit::Decode(REGISTER_BANK &registers, Instruction_Data &data){
@@ -106,32 +357,39 @@ void Control_Unit::Decode(REGISTER_BANK &registers, Instruction_Data &data){
 
     //cout <<instruction << endl;
 
-    if(data.op == "ADD" || data.op == "SUB" || data.op == "MULT" || data.op == "DIV"){
+    if(data.op == "ADD" || data.op == "SUB" || data.op == "MULT" || data.op == "DIV"
+        || data.op == "VADD" || data.op == "VSUB" || data.op == "VMUL" || data.op == "VCMP" || data.op == "VSUM"
+        || data.op == "DCOPY" || data.op == "DFILL" || data.op == "DSTAT"){
         // se entrar aqui é porque tem de carregar registradores, que estão especificados na instrução
         data.source_register = Get_source_Register(instruction);
         data.target_register = Get_target_Register(instruction);
         data.destination_register = Get_destination_Register(instruction);
 
-    }else if(data.op == "LI" || data.op == "LW" || data.op == "LA" || data.op == "SW")
+    }else if(data.op == "LI" || data.op == "LW" || data.op == "LA" || data.op == "SW" || data.op == "DREAD" || data.op == "DWRITE" || data.op == "ADDI")
     {
+        data.source_register = Get_source_Register(instruction);
         data.target_register = Get_target_Register(instruction);
         data.addressRAMResult = Get_immediate(instruction);
         //cout << "source register: " <<data.source_register << endl;
         //cout << "segundo registrador:" << data.addressRAMResult << endl;
 
-    }else if(data.op == "BLT" || data.op == "BGT" || data.op == "BGTI" || data.op == "BLTI"){
+    }else if(data.op == "BEQ" || data.op == "BLT" || data.op == "BGT" || data.op == "BGTI" || data.op == "BLTI"){
         data.source_register = Get_source_Register(instruction);
         data.target_register = Get_target_Register(instruction);
         data.addressRAMResult = Get_immediate(instruction);   
     }
-    else if(data.op == "J"){
+    else if(data.op == "J" || data.op == "JAL" || data.op == "SLEEP"){
         data.addressRAMResult = Get_immediate(instruction);
     }
+    else if(data.op == "JR" || data.op == "SETVL"){
+        data.source_register = Get_source_Register(instruction);
+    }
     else if(data.op == "PRINT"){
-        string instrucao = to_string(instruction);
-        if(Get_immediate(instruction) == "0000000000000000"){  //se for zero, então é um registrador
+        data.source_register = Get_source_Register(instruction);
+        if(data.source_register == "00000" && Get_immediate(instruction) == "0000000000000000"){  //se for zero, então é um registrador
             data.target_register = Get_target_Register(instruction);
-        }else{  //se não for zero, então é um valor imediato
+        }else{  //senão é uma posição de memória: offset(base) ou endereço absoluto
+            data.target_register = "";
             data.addressRAMResult = Get_immediate(instruction); 
         }
     }
@@ -142,12 +400,28 @@ void Control_Unit::Decode(REGISTER_BANK &registers, Instruction_Data &data){
 void Control_Unit::Execute(Instruction_Data &data, ControlContext &context){
     /*Daqui tem de ser chamado o que tiver de ser chamado*/
 
-    if(data.op == "ADD" ||  data.op == "SUB" || data.op == "MUL" || data.op == "DIV"){
+    if(!context.units.Timed() && !data.op.empty()){
+        unitUse use = context.units.Use(data.op, context.registers.vl.read());
+        context.units.Record(use, 0);
+        if(use.unit == UNIT_ALU || use.unit == UNIT_MUL || use.unit == UNIT_DIV){
+            // em ordem, a operação prende o EX e o pipeline inteiro espera por ela
+            context.time += use.latency - 1;
+        }
+    }
+
+    if(data.op == "ADD" ||  data.op == "SUB" || data.op == "MULT" || data.op == "DIV" || data.op == "ADDI"){
         Execute_Aritmetic_Operation(context.registers, data);
     }else if(data.op == "BEQ" || data.op == "J" || data.op == "BNE" || data.op == "BGT" || data.op == "BGTI" || data.op == "BLT" || data.op == "BLTI"){
         Execute_Loop_Operation(context.registers, data, context.counter,context.counterForEnd,context.endProgram,context.ram);
+        if(context.counter == 0){
+            // desvio tomado: desfaz o que o caminho descartado fez na pilha de retorno
+            context.ras.Restore(data.ras);
+        }
+    }else if(data.op == "JAL" || data.op == "JR"){
+        Execute_Call_Operation(data, context);
     }
-    else if( data.op == "PRINT" ){
+    else if( data.op == "PRINT" || data.op == "DREAD" || data.op == "DWRITE" || data.op == "SLEEP" || data.op == "DI" || data.op == "EI" || data.op == "SETVL"
+        || data.op == "DCOPY" || data.op == "DFILL" || data.op == "DSTAT" || data.op == "DWAIT" ){
         Execute_Operation(data,context);
     }
 
@@ -157,6 +431,196 @@ void Control_Unit::Execute(Instruction_Data &data, ControlContext &context){
     // demais operações realizadas no memory acess
 }
 
+// Registradores lidos e escritos pela instrução já decodificada e, nos acessos
+// à memória, o endereço efetivo, lido do banco antes de ela executar.
+void Control_Unit::Describe_Operation(Instruction_Data &data, ControlContext &context, scheduledOp &op){
+    const string &code = data.op;
+    string source = this->map.mp[data.source_register];
+    string target = this->map.mp[data.target_register];
+    string destination = this->map.mp[data.destination_register];
+    auto reads = [&op](const string &name){
+        if(!name.empty() && name != "zero" && op.sourceCount < MAX_OPERANDS){
+            op.sources[op.sourceCount++] = name;
+        }
+    };
+
+    op.use = context.units.Use(code, context.registers.vl.read());
+    if(code == "ADD" || code == "SUB" || code == "MULT" || code == "DIV"){
+        reads(source);
+        reads(target);
+        op.destination = destination;
+    }else if(code == "ADDI" || code == "LA"){
+        reads(source);
+        op.destination = target;
+    }else if(code == "LI" || code == "DREAD"){
+        op.destination = target;
+    }else if(code == "LW" || code == "SW" || (code == "PRINT" && data.target_register.empty())){
+        reads(source);
+        op.load = code != "SW";
+        op.store = code == "SW";
+        op.address = Effective_Address(context.registers, data);
+        if(code == "LW"){
+            op.destination = target;
+        }else if(code == "SW"){
+            reads(target);
+        }
+    }else if(code == "BEQ" || code == "BNE" || code == "BGT" || code == "BGTI" || code == "BLT" || code == "BLTI"){
+        reads(source);
+        reads(target);
+    }else if(code == "JAL"){
+        op.destination = "ra";
+    }else if(code == "JR"){
+        reads(source);
+    }else if(code == "PRINT" || code == "DWRITE"){
+        reads(target);
+    }else if(code == "SETVL"){
+        reads(source);
+        op.destination = "vl";
+    }else if(code == "VSUM"){
+        reads(source);
+        reads("vl");
+        op.destination = destination;
+    }else if(code == "VADD" || code == "VSUB" || code == "VMUL" || code == "VCMP"){
+        reads(source);
+        reads(target);
+        reads(destination);
+        reads("vl");
+    }else if(code == "DCOPY" || code == "DFILL"){
+        reads(source);
+        reads(target);
+        reads(destination);
+    }else if(code == "DSTAT"){
+        op.destination = destination;
+    }
+}
+
+// Registro do --trace de uma instrução que acabou de executar. op vem do
+// Describe_Operation, feito antes do Execute; um desvio conta como tomado se
+// esvaziou o pipeline ou é incondicional.
+void Control_Unit::Trace_Instruction(Instruction_Data &data, ControlContext &context, const scheduledOp &op){
+    static const unordered_map<string, uint8_t> numbers = []{
+        unordered_map<string, uint8_t> numbers;
+        for(const auto &[code, name] : Map().mp){
+            numbers[name] = stoul(code, nullptr, 2);
+        }
+        numbers["vl"] = TRACE_VL;
+        return numbers;
+    }();
+    auto number = [](const string &name) -> uint8_t {
+        auto entry = numbers.find(name);
+        return entry == numbers.end() ? TRACE_NO_REGISTER : entry->second;
+    };
+
+    string mnemonic = data.op;
+    transform(mnemonic.begin(), mnemonic.end(), mnemonic.begin(), ::tolower);
+    auto opcode = instructionMap.find(mnemonic);
+
+    traceRecord record{};
+    record.cycle = context.time;
+    record.pc = data.address;
+    record.pid = context.process.id;
+    record.core = context.irq.core;
+    record.opcode = opcode == instructionMap.end() ? 0xFF : stoul(opcode->second, nullptr, 2);
+    record.destination = op.destination.empty() ? TRACE_NO_REGISTER : number(op.destination);
+    for(int i = 0; i < TRACE_OPERANDS; i++){
+        record.sources[i] = i < op.sourceCount ? number(op.sources[i]) : TRACE_NO_REGISTER;
+    }
+
+    const string &code = data.op;
+    if(op.load || op.store){
+        record.flags = op.load ? TRACE_LOAD : TRACE_STORE;
+        record.address = op.address;
+    }else if(code == "BEQ" || code == "BNE" || code == "BGT" || code == "BGTI" || code == "BLT" || code == "BLTI"
+        || code == "J" || code == "JAL" || code == "JR"){
+        record.flags = TRACE_BRANCH;
+        if(context.counter == 0 || code == "J" || code == "JAL" || code == "JR"){
+            record.flags |= TRACE_TAKEN;
+        }
+        if(code != "JR"){
+            record.address = data.address + SignedImmediate(data.addressRAMResult);
+        }else if(op.sourceCount > 0){
+            record.address = context.registers.acessoLeituraRegistradores[op.sources[0]]();
+        }
+    }
+    context.trace->Record(context.irq.core, record);
+}
+
+// Núcleo com um timingModel (fora de ordem ou superescalar): cada instrução
+// passa inteira pelos estágios do Control_Unit, na ordem do programa, e o
+// modelo decide em que ciclo ela é confirmada. O tempo do núcleo é o do último
+// commit, então E/S e bloqueios acontecem na fronteira de uma instrução, como
+// em um processador com exceções precisas. Interrupções são aceitas na busca:
+// o que já foi buscado termina antes do tratador, como o pipeline drenando.
+void Control_Unit::Run_Timed(ControlContext &context, timingModel &engine, PIPELINE_COUNTERS &counters){
+    while(!context.endExecution){
+        context.irq.Tick(engine.NextFetch(0));
+        if(context.irq.pendingMask != 0){
+            hostSample sample(context.host, context.irq.core, HOST_INTERRUPT);
+            const uint64_t before = context.time;
+            Handle_Interrupts(context);
+            counters.Add(CPI_INTERRUPT, context.time - before);
+            if(context.profiler){
+                context.profiler->Tick(context.irq.core, context.process.id, PROFILE_INTERRUPT, context.time);
+            }
+            engine.Stall(context.time);
+            if(context.endExecution){
+                break;
+            }
+        }
+        Step_Timed(context, engine, 0, counters);
+    }
+}
+
+// Uma instrução do contexto de hardware `thread` do início ao fim.
+void Control_Unit::Step_Timed(ControlContext &context, timingModel &engine, int thread, PIPELINE_COUNTERS &counters){
+    const int core = context.irq.core;
+    Instruction_Data data{};
+    data.address = context.registers.pc.read();
+    {
+        hostSample sample(context.host, core, HOST_FETCH);
+        Fetch(data, context);
+    }
+    if(context.endProgram || context.registers.ir.read() == 0b11111100000000000000000000000000){
+        context.endProgram = true;
+        context.endExecution = true;
+        return;
+    }
+    {
+        hostSample sample(context.host, core, HOST_DECODE);
+        Decode(context.registers, data);
+    }
+
+    scheduledOp op;
+    op.thread = thread;
+    const uint64_t before = context.time;
+    {
+        hostSample sample(context.host, core, HOST_SCHEDULE);
+        Describe_Operation(data, context, op);
+        context.time = max(context.time, engine.Schedule(op));
+    }
+    counters.Commit(context.time - before, op.use.latency);
+    if(context.profiler){
+        context.profiler->Tick(core, context.process.id, data.address, context.time);
+    }
+
+    context.counter = 1;
+    {
+        hostSample sample(context.host, core, HOST_EXECUTE);
+        Execute(data, context);
+    }
+    {
+        hostSample sample(context.host, core, HOST_MEMORY);
+        Memory_Acess(data, context);
+    }
+    if(context.trace){
+        Trace_Instruction(data, context, op);
+    }
+    if(context.counter == 0){
+        engine.Redirect(thread);
+        counters.Flush();
+    }
+}
+
 void Control_Unit::Memory_Acess(Instruction_Data &data, ControlContext &context){
 
     
@@ -164,50 +628,39 @@ void Control_Unit::Memory_Acess(Instruction_Data &data, ControlContext &context)
 
     //aqui devem ser executadas as intruções de LOAD de fato
     if(data.op == "LW"){
-        int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
+        uint32_t decimal_value = Effective_Address(context.registers, data);
         //aqui tem de ser feito a leitura na RAM
         context.registers.acessoEscritaRegistradores[nameregister](context.ram.ReadMem(decimal_value));
         //cout << "valor da memória RAM: " << registers.acessoLeituraRegistradores[nameregister]() << endl;
     }
-    if(data.op == "LA" || data.op == "LI"){
-        int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
+    if(data.op == "LA"){
+        context.registers.acessoEscritaRegistradores[nameregister](Effective_Address(context.registers, data));
+    }
+    else if(data.op == "LI"){
+        int decimal_value = ConvertToDecimalValue(data.addressRAMResult);
         context.registers.acessoEscritaRegistradores[nameregister](decimal_value);
     }
+    else if(data.op == "SW"){
+        // a escrita acontece aqui e não no write back: lendo o registrador no
+        // WB, a instrução seguinte já teria passado pelo Execute e um desvio
+        // tomado logo depois descartaria o store
+        uint32_t decimal_value = Effective_Address(context.registers, data);
+        context.ram.WriteMem(decimal_value, context.registers.acessoLeituraRegistradores[nameregister]());
+    }
+    else if(data.op == "VADD" || data.op == "VSUB" || data.op == "VMUL" || data.op == "VCMP" || data.op == "VSUM"){
+        Execute_Vector_Operation(data, context);
+    }
     else if(data.op == "PRINT" && data.target_register == ""){
-        int decimalAddr = ConvertToDecimalValue(stoul(data.addressRAMResult));
+        uint32_t decimalAddr = Effective_Address(context.registers, data);
         auto value = context.ram.ReadMem(decimalAddr);
         
-        auto req = make_unique<ioRequest>();
-        req->msg = to_string(value);
-        req->process = &context.process;
-        context.ioRequests.push_back(move(req));
-        
-        if(context.printLock){
-            context.process.state = State::Blocked;
-            context.endExecution = true;
-        }
+        ioRequest req{value, 0, IO_PRINT, CONSOLE, 0};
+        Issue_IO_Request(req, data, context, 2, false);
     }
 
     return;
 }
 
-void Control_Unit::Write_Back(Instruction_Data &data, ControlContext &context){
-
-    string nameregister = this->map.mp[data.target_register];
-
-    //aqui devem ocorrer qualquer uma das intruções de escrita na RAM
-    if(data.op == "SW"){
-        //aqui tem de ser feito a escrita na RAM
-        int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-        //cout << decimal_value << endl;
-        context.ram.WriteMem(decimal_value, context.registers.acessoLeituraRegistradores[nameregister]()) ;
-        //cout << "valor da memória RAM: " << memory.ReadMem(decimal_value) << endl;
-    }
-
-    return;
-
-}
-
 string Control_Unit::Identificacao_instrucao(uint32_t instruction, REGISTER_BANK &registers){
 
     string instrucao = bitset<32>(instruction).to_string();
@@ -245,6 +698,30 @@ string Control_Unit::Identificacao_instrucao(uint32_t instruction, REGISTER_BANK
     else if (opcode == this->instructionMap.at("li")) {    
         instruction_type = "LI"; // LOAD IMMEDIATE
     }
+    else if (opcode == this->instructionMap.at("dread")) {    
+        instruction_type = "DREAD"; // DISK READ
+    }
+    else if (opcode == this->instructionMap.at("dwrite")) {    
+        instruction_type = "DWRITE"; // DISK WRITE
+    }
+    else if (opcode == this->instructionMap.at("sleep")) {    
+        instruction_type = "SLEEP"; // TIMER
+    }
+    else if (opcode == this->instructionMap.at("di")) {    
+        instruction_type = "DI"; // DISABLE INTERRUPTS
+    }
+    else if (opcode == this->instructionMap.at("ei")) {    
+        instruction_type = "EI"; // ENABLE INTERRUPTS
+    }
+    else if (opcode == this->instructionMap.at("jal")) {    
+        instruction_type = "JAL"; // CALL
+    }
+    else if (opcode == this->instructionMap.at("jr")) {    
+        instruction_type = "JR"; // RETURN
+    }
+    else if (opcode == this->instructionMap.at("addi")) {    
+        instruction_type = "ADDI";
+    }
 
     // instruções do tipo R
 
@@ -258,6 +735,26 @@ string Control_Unit::Identificacao_instrucao(uint32_t instruction, REGISTER_BANK
         instruction_type = "MULT";
     } else if (opcode == this->instructionMap.at("div")) {      
         instruction_type = "DIV";
+    } else if (opcode == this->instructionMap.at("vadd")) {
+        instruction_type = "VADD";
+    } else if (opcode == this->instructionMap.at("vsub")) {
+        instruction_type = "VSUB";
+    } else if (opcode == this->instructionMap.at("vmul")) {
+        instruction_type = "VMUL";
+    } else if (opcode == this->instructionMap.at("vsum")) {
+        instruction_type = "VSUM";
+    } else if (opcode == this->instructionMap.at("vcmp")) {
+        instruction_type = "VCMP";
+    } else if (opcode == this->instructionMap.at("setvl")) {
+        instruction_type = "SETVL"; // VECTOR LENGTH
+    } else if (opcode == this->instructionMap.at("dcopy")) {
+        instruction_type = "DCOPY"; // DMA COPY
+    } else if (opcode == this->instructionMap.at("dfill")) {
+        instruction_type = "DFILL"; // DMA FILL
+    } else if (opcode == this->instructionMap.at("dstat")) {
+        instruction_type = "DSTAT"; // DMA PENDENTES
+    } else if (opcode == this->instructionMap.at("dwait")) {
+        instruction_type = "DWAIT"; // ESPERA O DMA
     }
 
     return instruction_type;
@@ -332,7 +829,7 @@ void Control_Unit::Execute_Aritmetic_Operation(REGISTER_BANK &registers,Instruct
             alu.calculate();
             registers.acessoEscritaRegistradores[nameregisterdestination](alu.result);
             //cout << "resultado subtração:" << registers.acessoLeituraRegistradores[nameregisterdestination]() << endl;
-        }else if(data.op == "MUL"){
+        }else if(data.op == "MULT"){
             alu.A = registers.acessoLeituraRegistradores[nameregistersource]();
             alu.B = registers.acessoLeituraRegistradores[nametargetregister]();
             alu.op = MUL;
@@ -345,6 +842,12 @@ void Control_Unit::Execute_Aritmetic_Operation(REGISTER_BANK &registers,Instruct
             alu.op = DIV;
             alu.calculate();
             registers.acessoEscritaRegistradores[nameregisterdestination](alu.result);
+        }else if(data.op == "ADDI"){
+            alu.A = registers.acessoLeituraRegistradores[nameregistersource]();
+            alu.B = SignedImmediate(data.addressRAMResult);
+            alu.op = ADD;
+            alu.calculate();
+            registers.acessoEscritaRegistradores[nametargetregister](alu.result);
         }
 
         return;
@@ -362,8 +865,7 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BEQ;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
             counter = 0;
             counterForEnd = 5;
@@ -375,16 +877,14 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BNE;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
             counter = 0;
             counterForEnd = 5;
             programEnd = false;
         }
     }else if(data.op == "J"){
-        int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-        registers.pc.write(decimal_value);
+        registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
         registers.ir.write(ram.ReadMem(registers.pc.read()));
 
         //cout << "Jump to: " << registers.pc.read();
@@ -397,8 +897,7 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BLT;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
             counter = 0;
             counterForEnd = 5;
@@ -410,8 +909,7 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BLTI;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
             counter = 0;
             counterForEnd = 5;
@@ -423,8 +921,7 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BGT;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
             counter = 0;
             counterForEnd = 5;
@@ -436,8 +933,7 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
         alu.op = BGTI;
         alu.calculate();
         if(alu.result == 1){
-            int decimal_value = ConvertToDecimalValue(stoul(data.addressRAMResult));
-            registers.pc.write(decimal_value);
+            registers.pc.write(data.address + SignedImmediate(data.addressRAMResult));
             registers.ir.write(ram.ReadMem(registers.pc.read()));
 
             counter = 0;
@@ -448,20 +944,206 @@ void Control_Unit::Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_D
     return;
 }
 
+// jal já foi desviado no Fetch; aqui só grava $ra. jr confere o destino
+// previsto pela pilha de retorno e, se errou, esvazia o pipeline como um desvio.
+void Control_Unit::Execute_Call_Operation(Instruction_Data &data, ControlContext &context){
+    if(data.op == "JAL"){
+        context.registers.ra.write(data.address + 1);
+        context.process.calls += 1;
+        if(context.profiler){
+            context.profiler->Call(context.process.id, data.address, data.address + SignedImmediate(data.addressRAMResult));
+        }
+        return;
+    }
+
+    string nameregistersource = this->map.mp[data.source_register];
+    uint32_t target = context.registers.acessoLeituraRegistradores[nameregistersource]();
+    if(nameregistersource == "ra"){
+        context.process.returns += 1;
+        if(context.profiler){
+            context.profiler->Return(context.process.id);
+        }
+    }
+    if(data.predicted && data.predictedTarget == target){
+        return;
+    }
+    if(nameregistersource == "ra"){
+        context.process.returnsMispredicted += 1;
+    }
+
+    context.registers.pc.write(target);
+    context.registers.ir.write(context.ram.ReadMem(target));
+    context.counter = 0;
+    context.counterForEnd = 5;
+    context.endProgram = false;
+    context.ras.Restore(data.ras);
+}
+
 void Control_Unit::Execute_Operation(Instruction_Data &data, ControlContext &context){
     string nameregister = this->map.mp[data.target_register];
 
     if(data.op == "PRINT" && data.target_register != ""){
         auto value = context.registers.acessoLeituraRegistradores[nameregister]();
-        auto req = make_unique<ioRequest>();
-        req->msg = to_string(value);
-        req->process = &context.process;
-        context.ioRequests.push_back(move(req));
-        
-        if(context.printLock){
-            context.process.state = State::Blocked;
+        ioRequest req{value, 0, IO_PRINT, CONSOLE, 0};
+        Issue_IO_Request(req, data, context, 3, false);
+    }
+    else if(data.op == "DWRITE"){
+        auto value = context.registers.acessoLeituraRegistradores[nameregister]();
+        uint32_t block = ConvertToDecimalValue(data.addressRAMResult);
+        ioRequest req{value, block, IO_DISK_WRITE, DISK, 0};
+        Issue_IO_Request(req, data, context, 3, false);
+    }
+    else if(data.op == "DREAD"){
+        // o registrador é escrito quando o disco concluir, com o processo bloqueado
+        uint32_t block = ConvertToDecimalValue(data.addressRAMResult);
+        uint8_t code = stoul(data.target_register, nullptr, 2);
+        ioRequest req{0, block, IO_DISK_READ, DISK, code};
+        Issue_IO_Request(req, data, context, 3, true);
+    }
+    else if(data.op == "SLEEP"){
+        uint32_t ticks = ConvertToDecimalValue(data.addressRAMResult);
+        ioRequest req{0, ticks, IO_SLEEP, TIMER, 0};
+        Issue_IO_Request(req, data, context, 3, true);
+    }
+    else if(data.op == "DI"){
+        context.registers.sr.write(context.registers.sr.read() & ~SR_IE);
+    }
+    else if(data.op == "EI"){
+        context.registers.sr.write(context.registers.sr.read() | SR_IE);
+    }
+    else if(data.op == "SETVL"){
+        string nameregistersource = this->map.mp[data.source_register];
+        context.registers.vl.write(context.registers.acessoLeituraRegistradores[nameregistersource]());
+    }
+    else if(data.op == "DCOPY" || data.op == "DFILL"){
+        // dcopy rd, rs, rt: copia rt palavras de rs para rd; dfill preenche com o valor de rs.
+        // O DMA trabalha em segundo plano e avisa a conclusão por interrupção.
+        string nameregistersource = this->map.mp[data.source_register];
+        string nametargetregister = this->map.mp[data.target_register];
+        string nameregisterdestination = this->map.mp[data.destination_register];
+        uint32_t source = context.registers.acessoLeituraRegistradores[nameregistersource]();
+        uint32_t target = context.registers.acessoLeituraRegistradores[nameregisterdestination]();
+        ioRequest req{source, target, (uint8_t)(data.op == "DCOPY" ? IO_DMA_COPY : IO_DMA_FILL), DMA, 0};
+        req.length = context.registers.acessoLeituraRegistradores[nametargetregister]();
+        Issue_IO_Request(req, data, context, 3, false);
+    }
+    else if(data.op == "DSTAT"){
+        string nameregisterdestination = this->map.mp[data.destination_register];
+        context.registers.acessoEscritaRegistradores[nameregisterdestination](context.process.pendingDMA.load());
+    }
+    else if(data.op == "DWAIT"){
+        if(context.process.pendingDMA > 0){
+            context.process.waitingDMA = true;
+            context.process.dmaWaitStart = context.time;
+            Suspend_Pipeline(data, context, 3, false);
+        }
+    }
+}
+
+// Operam sobre vl palavras contíguas da RAM a partir dos endereços nos
+// registradores: vadd/vsub/vmul/vcmp escrevem em rd[i] o resultado de rs[i] e
+// rt[i]; vsum soma rs[0..vl) no registrador rd. Os kernels do host rodam uma
+// faixa de linha da MainMemory por vez e o estágio fica ocupado
+// ceil(vl / VECTOR_LANES) ciclos.
+void Control_Unit::Execute_Vector_Operation(Instruction_Data &data, ControlContext &context){
+    REGISTER_BANK &registers = context.registers;
+    string nameregistersource = this->map.mp[data.source_register];
+    string nametargetregister = this->map.mp[data.target_register];
+    string nameregisterdestination = this->map.mp[data.destination_register];
+
+    const size_t count = registers.vl.read();
+    const uint32_t a = registers.acessoLeituraRegistradores[nameregistersource]();
+    const uint32_t b = registers.acessoLeituraRegistradores[nametargetregister]();
+    const uint32_t out = registers.acessoLeituraRegistradores[nameregisterdestination]();
+    const bool sum = data.op == "VSUM";
+    vectorOperation op = data.op == "VADD" ? VEC_ADD : data.op == "VSUB" ? VEC_SUB : data.op == "VMUL" ? VEC_MUL : VEC_CMP;
+
+    uint32_t total = 0;
+    size_t done = 0;
+    while(done < count){
+        size_t runA, runB = count, runOut = count;
+        const uint32_t *x = context.ram.Words(a + done, runA);
+        const uint32_t *y = sum ? x : context.ram.Words(b + done, runB);
+        uint32_t *z = sum ? nullptr : context.ram.Words(out + done, runOut);
+        if(x == nullptr || y == nullptr || (!sum && z == nullptr)){
+            cerr << "Endereço inválido na instrução vetorial " << data.op << endl;
+            break;
+        }
+        size_t run = min({count - done, runA, runB, runOut});
+        if(sum){
+            total += VectorSum(x, run);
+        }else{
+            VectorBinary(op, x, y, z, run);
+        }
+        done += run;
+    }
+
+    if(sum){
+        registers.acessoEscritaRegistradores[nameregisterdestination](total);
+    }
+    if(count > VECTOR_LANES && !context.units.Timed()){
+        // com um timingModel a ocupação já entra no modelo (EXECUTION_UNITS::Use)
+        context.time += (count + VECTOR_LANES - 1) / VECTOR_LANES - 1;
+    }
+    context.process.vectorInstructions += 1;
+    context.process.vectorElements += count;
+}
+
+// Chamado entre ciclos quando há interrupção pendente. O pipeline fica parado
+// enquanto o tratador roda e os ciclos gastos são contados como do kernel.
+// O timer encerra o quantum: o pipeline é drenado e o processo volta ao
+// escalonador. As demais linhas são conclusões de E/S que acordam processos.
+void Control_Unit::Handle_Interrupts(ControlContext &context){
+    interruptEntry entry;
+    while(context.irq.Next(context.registers, context.time, entry)){
+        if(entry.line == IRQ_TIMER){
             context.endExecution = true;
+        }else{
+            context.io.HandleCompletion(entry.request, context.time);
         }
+        context.time += IRQ_HANDLER_CYCLES;
+        context.units.handlerCycles += IRQ_HANDLER_CYCLES;
+        context.irq.Return(context.registers, IRQ_HANDLER_CYCLES);
+    }
+}
+
+// Envia o pedido para a fila do dispositivo. O processo bloqueia quando precisa
+// do resultado (wait) ou quando o dispositivo já está ocupado.
+void Control_Unit::Issue_IO_Request(ioRequest &req, Instruction_Data &data, ControlContext &context, int stage, bool wait){
+    req.process = &context.process;
+    req.issued = context.time;
+    bool busy = context.io.devices[req.device]->Busy();
+    bool dma = req.device == DMA;
+
+    context.process.pendingIO.fetch_add(1);
+    context.process.pendingDMA.fetch_add(dma);
+    if(!context.io.Submit(req, context.irq.core)){
+        // fila cheia: o processo bloqueia e a instrução é refeita quando houver espaço
+        context.process.pendingIO.fetch_sub(1);
+        context.process.pendingDMA.fetch_sub(dma);
+        context.process.waitingIOSpace = req.device;
+        Suspend_Pipeline(data, context, stage, true);
+        return;
+    }
+
+    // o DMA trabalha em segundo plano: com ele ocupado o pedido só espera na fila
+    if(wait || (busy && !dma)){
+        context.process.waitingIO = true;
+        Suspend_Pipeline(data, context, stage, false);
+    }
+}
+
+// Encerra a execução a partir da instrução que está no estágio `stage`
+// (mesma numeração de counterForEnd: 3 = EX, 2 = MEM). As instruções mais novas
+// são descartadas e o pc aponta para a instrução seguinte, ou para a própria
+// instrução quando replay for verdadeiro, para que o processo retome no ponto exato.
+void Control_Unit::Suspend_Pipeline(Instruction_Data &data, ControlContext &context, int stage, bool replay){
+    context.registers.pc.write(replay ? data.address : data.address + 1);
+    context.registers.ir.write(0);
+    context.endProgram = false;
+    context.endExecution = true;
+    if(context.counterForEnd > stage){
+        context.counterForEnd = stage;
     }
 }
 
@@ -4,8 +4,18 @@
 #include "ALU.h"
 #include "REGISTER_BANK.h"
 #include"HashRegister.h"
+#include"INTERRUPT_CONTROLLER.h"
+#include"RETURN_ADDRESS_STACK.h"
+#include"EXECUTION_UNITS.h"
+#include"PIPELINE_COUNTERS.h"
+#include"TOMASULO.h"
+#include"SUPERSCALAR.h"
+#include"VECTOR_UNIT.h"
 #include"unordered_map"
 #include"../memory/MAINMEMORY.h"
+#include"../sim/PROFILER.h"
+#include"../sim/TRACE_RECORDER.h"
+#include"../sim/HOST_COUNTERS.h"
 #include"../PCB.h"
 #include <string>
 #include <vector>
@@ -14,7 +24,25 @@
 #include <cmath>
 #include <mutex>
 
-void* Core(MainMemory &ram, PCB &process, vector<unique_ptr<ioRequest>>* ioRequests, bool &printLock);
+// O que um núcleo usa em todo quantum: o estado dele, mantido entre quanta, e
+// os observadores opcionais. Montado por quem despacha o núcleo (coreDispatch,
+// RunWindow) e passado inteiro para Core()/Core_SMT().
+struct coreResources {
+    MainMemory &ram;
+    IO_SUBSYSTEM &io;
+    INTERRUPT_CONTROLLER &irq;
+    RETURN_ADDRESS_STACK *ras;      // uma por contexto de hardware
+    EXECUTION_UNITS &units;
+    PIPELINE_COUNTERS &counters;
+    PROFILER *profiler;             // nullptr sem --profile
+    TRACE_RECORDER *trace;          // nullptr sem --trace
+    HOST_COUNTERS *host;            // nullptr sem --perf
+};
+
+coreResources Core_Resources(scheduleInfo &info, int core);
+void* Core(coreResources &core, PCB &process, uint64_t &time);
+void* Core_SMT(coreResources &core, const vector<PCB*> &processes, uint64_t &time);
+void Idle_Interrupts(INTERRUPT_CONTROLLER &irq, IO_SUBSYSTEM &io, uint64_t &time);
 
 struct Instruction_Data{
     string source_register;
@@ -22,20 +50,30 @@ struct Instruction_Data{
     string destination_register;
     string op;
     string addressRAMResult;
+    uint32_t address;   // endereço da instrução na RAM, usado para retomar o processo
 
+    bool predicted;             // jr com destino previsto pela pilha de retorno
+    uint32_t predictedTarget;
+    rasCheckpoint ras;          // pilha de retorno logo após o fetch desta instrução
 };
 
 
 struct ControlContext {
     REGISTER_BANK &registers;
     MainMemory &ram;
-    vector<unique_ptr<ioRequest>> &ioRequests;
-    bool &printLock;
+    IO_SUBSYSTEM &io;
+    uint64_t &time;     // tempo virtual local do núcleo
+    INTERRUPT_CONTROLLER &irq;
+    RETURN_ADDRESS_STACK &ras;  // do núcleo, mantida entre quanta
+    EXECUTION_UNITS &units;     // do núcleo: latências, modo fora de ordem e ocupação
     PCB &process;
     int &counter;
     int &counterForEnd;
     bool &endProgram;
     bool &endExecution;
+    PROFILER *profiler;         // nullptr sem --profile
+    TRACE_RECORDER *trace;      // nullptr sem --trace
+    HOST_COUNTERS *host;        // nullptr sem --perf
 };
 
 struct Control_Unit{
@@ -64,9 +102,31 @@ struct Control_Unit{
         {"li", "001110"},
         {"la", "001111"},
         {"print", "010000"},
+        {"dread", "010001"},
+        {"dwrite","010010"},
+        {"sleep", "010011"},
+        {"di",    "010100"},
+        {"ei",    "010101"},
+        {"jal",   "010110"},
+        {"jr",    "010111"},
+        {"addi",  "011000"},
+        {"vadd",  "011001"},
+        {"vsub",  "011010"},
+        {"vmul",  "011011"},
+        {"vsum",  "011100"},
+        {"vcmp",  "011101"},
+        {"setvl", "011110"},
+        {"dcopy", "011111"},
+        {"dfill", "100000"},
+        {"dstat", "100001"},
+        {"dwait", "100010"},
         {"end", "111111"}
     };
 
+    // opcodes pré-decodificados no Fetch
+    const uint32_t jalOpcode = stoul(instructionMap.at("jal"), nullptr, 2);
+    const uint32_t jrOpcode = stoul(instructionMap.at("jr"), nullptr, 2);
+
     string Get_immediate(const uint32_t instruction);
     string Pick_Code_Register_Load(const uint32_t instruction);
     string Get_destination_Register(const uint32_t instruction);
@@ -74,14 +134,24 @@ struct Control_Unit{
     string Get_source_Register(const uint32_t instruction);
 
     string Identificacao_instrucao(uint32_t instruction, REGISTER_BANK &registers);
-    void Fetch(ControlContext &context);
+    void Fetch(Instruction_Data &data, ControlContext &context);
     void Decode(REGISTER_BANK &registers, Instruction_Data &data);
     void Execute_Aritmetic_Operation(REGISTER_BANK &registers,Instruction_Data &data);
     void Execute_Operation(Instruction_Data &data,ControlContext &context);
+    uint32_t Effective_Address(REGISTER_BANK &registers, Instruction_Data &data);
     void Execute_Loop_Operation(REGISTER_BANK &registers,Instruction_Data &data, int &counter, int &counterForEnd, bool& endProgram, MainMemory& ram); 
+    void Execute_Call_Operation(Instruction_Data &data, ControlContext &context);
+    void Execute_Vector_Operation(Instruction_Data &data, ControlContext &context);
     void Execute(Instruction_Data &data, ControlContext &context);
+    void Describe_Operation(Instruction_Data &data, ControlContext &context, scheduledOp &op);
+    void Trace_Instruction(Instruction_Data &data, ControlContext &context, const scheduledOp &op);
+    void Run_Timed(ControlContext &context, timingModel &engine, PIPELINE_COUNTERS &counters);
+    void Step_Timed(ControlContext &context, timingModel &engine, int thread, PIPELINE_COUNTERS &counters);
     void Memory_Acess(Instruction_Data &data, ControlContext &context);
-    void Write_Back(Instruction_Data &data, ControlContext &context);
+
+    void Issue_IO_Request(ioRequest &req, Instruction_Data &data, ControlContext &context, int stage, bool wait);
+    void Suspend_Pipeline(Instruction_Data &data, ControlContext &context, int stage, bool replay);
+    void Handle_Interrupts(ControlContext &context);
 };
 
 #endif
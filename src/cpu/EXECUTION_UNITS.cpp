@@ -0,0 +1,137 @@
+#include "EXECUTION_UNITS.h"
+#include "VECTOR_UNIT.h"
+
+#include <algorithm>
+#include <iomanip>
+
+unitUse EXECUTION_UNITS::Use(const string &op, uint32_t vectorLength) const{
+    auto configured = latency.find(op);
+    unsigned cycles = configured == latency.end() ? 1 : configured->second;
+
+    unitClass unit = UNIT_ALU;
+    bool serializing = false;
+    if(op == "MULT"){
+        unit = UNIT_MUL;
+    }else if(op == "DIV"){
+        unit = UNIT_DIV;
+    }else if(op == "LW" || op == "SW"){
+        unit = UNIT_MEM;
+    }else if(op == "VADD" || op == "VSUB" || op == "VMUL" || op == "VCMP" || op == "VSUM"){
+        // lê e escreve faixas da RAM: espera os stores anteriores e ocupa a
+        // unidade ceil(vl / VECTOR_LANES) ciclos
+        unit = UNIT_MEM;
+        cycles = max<uint32_t>(1, (vectorLength + VECTOR_LANES - 1) / VECTOR_LANES);
+        serializing = true;
+    }else if(op == "BEQ" || op == "BNE" || op == "BGT" || op == "BGTI" || op == "BLT" || op == "BLTI"
+        || op == "J" || op == "JAL" || op == "JR"){
+        unit = UNIT_BRANCH;
+    }else if(op == "PRINT" || op == "DREAD" || op == "DWRITE" || op == "SLEEP" || op == "DI" || op == "EI" || op == "SETVL"
+        || op == "DCOPY" || op == "DFILL" || op == "DSTAT" || op == "DWAIT"){
+        unit = UNIT_SYSTEM;
+        serializing = true;
+    }
+
+    unsigned occupancy = config[unit].pipelined && !serializing ? 1 : cycles;
+    return unitUse{unit, cycles, occupancy, serializing};
+}
+
+// op como no assembly ("mult"); só as operações da ULA têm latência configurável
+bool EXECUTION_UNITS::SetLatency(const string &op, unsigned cycles){
+    string name = op;
+    transform(name.begin(), name.end(), name.begin(), ::toupper);
+    auto entry = latency.find(name);
+    if(entry == latency.end() || cycles == 0){
+        return false;
+    }
+    entry->second = cycles;
+    return true;
+}
+
+// 1, 2 ou 4. Cada via ganha uma ALU e cada par de vias uma porta de memória,
+// com estações de reserva para manter as unidades ocupadas.
+bool EXECUTION_UNITS::SetIssueWidth(unsigned width){
+    if(width != 1 && width != 2 && width != 4){
+        return false;
+    }
+    issueWidth = width;
+    config[UNIT_ALU].count = max(2u, width);
+    config[UNIT_ALU].stations = max(4u, 2 * width);
+    config[UNIT_MEM].count = max(1u, width / 2);
+    config[UNIT_MEM].stations = max(4u, 2 * width);
+    return true;
+}
+
+bool EXECUTION_UNITS::Timed() const{
+    return outOfOrder || issueWidth > 1;
+}
+
+// SMT: 1 a MAX_CONTEXTS contextos por núcleo, com a política "rr" ou "icount".
+// Os contextos compartilham o núcleo fora de ordem.
+bool EXECUTION_UNITS::SetContexts(unsigned count, const string &policyName){
+    if(count < 1 || count > MAX_CONTEXTS || (policyName != "rr" && policyName != "icount")){
+        return false;
+    }
+    contexts = count;
+    policy = policyName == "icount" ? FETCH_ICOUNT : FETCH_ROUND_ROBIN;
+    if(count > 1){
+        outOfOrder = true;
+    }
+    return true;
+}
+
+void EXECUTION_UNITS::Record(const unitUse &use, int thread){
+    instructions += 1;
+    contextInstructions[thread] += 1;
+    operations[use.unit] += 1;
+    busy[use.unit] += use.occupancy;
+}
+
+string EXECUTION_UNITS::ModeName() const{
+    string name = string(outOfOrder ? "out-of-order" : "in-order") + " x" + to_string(issueWidth);
+    if(contexts > 1){
+        name += ", " + to_string(contexts) + " contexts (" + (policy == FETCH_ICOUNT ? "icount" : "rr") + ")";
+    }
+    return name;
+}
+
+void EXECUTION_UNITS::PrintStats(ostream &out, int core) const{
+    static const char* splitNames[NUM_SPLITS] = {"dependency", "unit", "ports", "taken branch", "serial", "fetch"};
+
+    out << "[core " << core << "] " << ModeName() << ": "
+        << instructions << " instructions, " << cycles << " cycles, IPC "
+        << fixed << setprecision(2) << (cycles ? (double)instructions / cycles : 0.0)
+        << " (" << (cycles > handlerCycles ? (double)instructions / (cycles - handlerCycles) : 0.0)
+        << " outside interrupt handlers)";
+    if(outOfOrder){
+        out << ", ROB full " << robStalls << ", stations full " << stationStalls << ", redirects " << redirects;
+    }
+    out << endl;
+
+    if(!outOfOrder && issueWidth > 1){
+        out << "  groups " << groups << " (";
+        for(unsigned size = 1; size <= issueWidth; size++){
+            out << (size > 1 ? ", " : "") << size << ": " << groupSizes[size];
+        }
+        out << "), split by";
+        for(int reason = 0; reason < NUM_SPLITS; reason++){
+            out << (reason ? ", " : " ") << splitNames[reason] << " " << splits[reason];
+        }
+        out << endl;
+    }
+
+    if(contexts > 1){
+        for(unsigned thread = 0; thread < contexts; thread++){
+            out << "  context " << thread << ": " << contextInstructions[thread] << " instructions, IPC "
+                << (cycles ? (double)contextInstructions[thread] / cycles : 0.0) << ", "
+                << contextFilled[thread] << " fetched while another context was stalled" << endl;
+        }
+    }
+
+    for(int unit = 0; unit < NUM_UNITS; unit++){
+        uint64_t capacity = cycles * config[unit].count;
+        out << "  " << left << setw(7) << config[unit].name << right
+            << operations[unit] << " ops, occupancy "
+            << (capacity ? 100.0 * busy[unit] / capacity : 0.0) << "%" << endl;
+    }
+    out << defaultfloat;
+}
@@ -0,0 +1,134 @@
+#ifndef EXECUTION_UNITS_H
+#define EXECUTION_UNITS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+using namespace std;
+
+enum unitClass {
+    UNIT_ALU,       // add, sub, addi, li, la
+    UNIT_MUL,       // mult
+    UNIT_DIV,       // div
+    UNIT_MEM,       // lw, sw e instruções vetoriais
+    UNIT_BRANCH,    // desvios, j, jal e jr
+    UNIT_SYSTEM,    // E/S, DMA, di/ei e setvl
+    NUM_UNITS
+};
+
+struct unitConfig {
+    const char* name;
+    unsigned count;         // unidades iguais
+    unsigned stations;      // estações de reserva no modo fora de ordem
+    bool pipelined;         // aceita uma operação nova a cada ciclo
+};
+
+// Uso de uma unidade por uma instrução. occupancy é quantos ciclos a unidade
+// fica sem aceitar outra operação; serializing faz a instrução esperar as
+// anteriores terminarem (efeitos fora dos registradores).
+struct unitUse {
+    unitClass unit;
+    unsigned latency;
+    unsigned occupancy;
+    bool serializing;
+};
+
+#define MAX_OPERANDS 4
+#define MAX_ISSUE_WIDTH 4
+#define MAX_CONTEXTS 4
+#define READ_PORTS_PER_LANE 2       // portas do REGISTER_BANK por instrução emitida no ciclo
+#define WRITE_PORTS_PER_LANE 1
+
+// Instrução como os modelos de tempo a veem: a unidade que usa, os
+// registradores lidos e o escrito e, nos acessos à memória, o endereço efetivo.
+struct scheduledOp {
+    int thread = 0;         // contexto de hardware (SMT)
+    unitUse use;
+    string sources[MAX_OPERANDS];
+    int sourceCount = 0;
+    string destination;     // vazio quando não escreve registrador
+    bool load = false;
+    bool store = false;
+    uint32_t address = 0;
+};
+
+// Modelo de tempo de um núcleo em que as instruções passam inteiras pelos
+// estágios do Control_Unit, na ordem do programa: o modelo só decide em que
+// ciclo cada uma é confirmada (TOMASULO, SUPERSCALAR).
+struct timingModel {
+    virtual uint64_t Schedule(const scheduledOp &op) = 0;   // devolve o ciclo de commit
+    virtual void Redirect(int thread) = 0;                  // a última instrução do contexto desviou o fetch
+    virtual void Stall(uint64_t now) = 0;                   // ciclos gastos fora do pipeline
+    virtual uint64_t NextFetch(int thread) const = 0;
+    virtual ~timingModel() = default;
+};
+
+// Por que uma instrução não entrou no mesmo grupo de emissão da anterior
+enum splitReason {
+    SPLIT_DEPENDENCY,   // lê ou escreve o que o grupo escreve (registrador ou endereço)
+    SPLIT_UNIT,         // todas as unidades da sua classe já usadas no grupo
+    SPLIT_PORTS,        // portas de leitura ou escrita do banco esgotadas
+    SPLIT_BRANCH,       // desvio tomado no grupo: o resto da busca é descartado
+    SPLIT_SERIAL,       // instrução que executa sozinha
+    SPLIT_FETCH,        // ainda não buscada quando o grupo entrou no EX
+    NUM_SPLITS
+};
+
+// Escolha do contexto que busca quando mais de um pode buscar no mesmo ciclo
+enum fetchPolicy {
+    FETCH_ROUND_ROBIN,
+    FETCH_ICOUNT        // o com menos instruções buscadas e ainda não confirmadas
+};
+
+// Unidades funcionais de um núcleo, com as latências por opcode e a ocupação
+// de cada classe de unidade. Em ordem, uma operação longa prende o EX; fora
+// de ordem (TOMASULO) as instruções independentes seguem enquanto ela executa.
+struct EXECUTION_UNITS {
+    unitConfig config[NUM_UNITS] = {
+        {"alu",    2, 4, true},
+        {"mul",    1, 2, true},
+        {"div",    1, 2, false},
+        {"mem",    1, 4, true},
+        {"branch", 1, 2, true},
+        {"system", 1, 1, true}
+    };
+    // ciclos no EX por opcode (nome decodificado); os demais levam 1
+    unordered_map<string, unsigned> latency = {
+        {"ADD", 1},
+        {"SUB", 1},
+        {"ADDI", 1},
+        {"MULT", 3},
+        {"DIV", 12}
+    };
+    bool outOfOrder = false;
+    unsigned issueWidth = 1;            // instruções buscadas, emitidas e confirmadas por ciclo
+    unsigned contexts = 1;              // contextos de hardware (SMT), cada um com um processo
+    fetchPolicy policy = FETCH_ROUND_ROBIN;
+
+    uint64_t cycles = 0;                // ciclos com processo no núcleo
+    uint64_t handlerCycles = 0;         // ... dos quais em tratadores de interrupção
+    uint64_t instructions = 0;          // instruções concluídas
+    uint64_t operations[NUM_UNITS] = {};
+    uint64_t busy[NUM_UNITS] = {};      // ciclos em que a unidade não aceitava operação nova
+    uint64_t robStalls = 0;             // ciclos de despacho perdidos com o ROB cheio
+    uint64_t stationStalls = 0;         // ... sem estação de reserva livre
+    uint64_t redirects = 0;             // desvios tomados e retornos mal previstos
+    uint64_t groups = 0;                // grupos de emissão em ordem com issueWidth > 1
+    uint64_t groupSizes[MAX_ISSUE_WIDTH + 1] = {};
+    uint64_t splits[NUM_SPLITS] = {};   // grupos encerrados antes de encher, por motivo
+    uint64_t contextInstructions[MAX_CONTEXTS] = {};
+    uint64_t contextFilled[MAX_CONTEXTS] = {};  // buscas em ciclos em que outro contexto estava parado
+
+    unitUse Use(const string &op, uint32_t vectorLength) const;
+    bool SetLatency(const string &op, unsigned cycles);
+    bool SetIssueWidth(unsigned width);
+    bool SetContexts(unsigned count, const string &policyName);
+    bool Timed() const;     // usa um timingModel em vez do pipeline de 5 estágios
+    string ModeName() const;
+    void Record(const unitUse &use, int thread);
+    void PrintStats(ostream &out, int core) const;
+};
+
+#endif
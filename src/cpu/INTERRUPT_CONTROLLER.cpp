@@ -0,0 +1,109 @@
+#include "INTERRUPT_CONTROLLER.h"
+
+#include <algorithm>
+
+static const char* lineNames[NUM_IRQ_LINES] = {"timer", "disk", "console", "sleep", "dma"};
+
+INTERRUPT_CONTROLLER::INTERRUPT_CONTROLLER(int core)
+    : core(core), pendingMask(0), lock("irq"), timerDeadline(UINT64_MAX), kernelCycles(0)
+{
+    for (int i = 0; i < NUM_IRQ_LINES; i++) {
+        taken[i] = 0;
+        latencySum[i] = 0;
+        maxLatency[i] = 0;
+    }
+    kernelRegisters.sr.write(SR_DEFAULT);
+}
+
+void INTERRUPT_CONTROLLER::Raise(uint8_t line, uint64_t time, const ioRequest &request)
+{
+    profiledGuard guard(lock);
+    pending.push_back(interruptEntry{line, time, request});
+    pendingMask |= 1u << line;
+}
+
+void INTERRUPT_CONTROLLER::ArmTimer(uint64_t deadline)
+{
+    timerDeadline = deadline;
+}
+
+void INTERRUPT_CONTROLLER::DisarmTimer()
+{
+    timerDeadline = UINT64_MAX;
+
+    // um quantum vencido e não atendido não vale para o próximo processo
+    profiledGuard guard(lock);
+    pending.erase(remove_if(pending.begin(), pending.end(),
+                            [](const interruptEntry &e) { return e.line == IRQ_TIMER; }),
+                  pending.end());
+    pendingMask &= ~(1u << IRQ_TIMER);
+}
+
+void INTERRUPT_CONTROLLER::Tick(uint64_t now)
+{
+    if (now >= timerDeadline) {
+        Raise(IRQ_TIMER, timerDeadline, ioRequest{});
+        timerDeadline = UINT64_MAX;
+    }
+}
+
+// Retira a interrupção pendente mais prioritária que o sr permite atender.
+bool INTERRUPT_CONTROLLER::Next(REGISTER_BANK &registers, uint64_t now, interruptEntry &entry)
+{
+    uint32_t sr = registers.sr.read();
+    if (!(sr & SR_IE) || (sr & SR_EXL)) {
+        return false;
+    }
+
+    uint32_t raised = pendingMask.load();
+    uint32_t enabled = raised & ((sr >> SR_IM_SHIFT) & 0xFF);
+    if (enabled == 0) {
+        return false;
+    }
+    uint8_t line = __builtin_ctz(enabled);
+
+    {
+        profiledGuard guard(lock);
+        auto sameLine = [line](const interruptEntry &e) { return e.line == line; };
+        auto it = find_if(pending.begin(), pending.end(), sameLine);
+        if (it == pending.end()) {
+            pendingMask &= ~(1u << line);
+            return false;
+        }
+        entry = *it;
+        it = pending.erase(it);
+        if (find_if(it, pending.end(), sameLine) == pending.end()) {
+            pendingMask &= ~(1u << line);
+        }
+    }
+
+    uint64_t latency = now > entry.raised ? now - entry.raised : 0;
+    taken[line] += 1;
+    latencySum[line] += latency;
+    maxLatency[line] = max(maxLatency[line], latency);
+
+    registers.cr.write((raised << CR_IP_SHIFT) | ((uint32_t)line << CR_CODE_SHIFT));
+    registers.epc.write(registers.pc.read());
+    registers.sr.write(sr | SR_EXL);
+    return true;
+}
+
+void INTERRUPT_CONTROLLER::Return(REGISTER_BANK &registers, uint64_t cycles)
+{
+    kernelCycles += cycles;
+    registers.pc.write(registers.epc.read());
+    registers.sr.write(registers.sr.read() & ~SR_EXL);
+}
+
+void INTERRUPT_CONTROLLER::PrintStats(ostream &out) const
+{
+    out << "Core " << core << " interrupts: kernel " << kernelCycles << " cycles";
+    for (int i = 0; i < NUM_IRQ_LINES; i++) {
+        if (taken[i] == 0) {
+            continue;
+        }
+        out << ", " << lineNames[i] << " " << taken[i]
+            << " (latency avg " << (double)latencySum[i] / taken[i] << ", max " << maxLatency[i] << ")";
+    }
+    out << endl;
+}
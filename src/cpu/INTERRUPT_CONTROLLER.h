@@ -0,0 +1,74 @@
+#ifndef INTERRUPT_CONTROLLER_H
+#define INTERRUPT_CONTROLLER_H
+
+#include "REGISTER_BANK.h"
+#include "../io/IO_QUEUE.h"
+#include "../sim/LOCK_PROFILER.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+
+using namespace std;
+
+// bits do registrador sr
+#define SR_IE           0x00000001      // interrupções habilitadas
+#define SR_EXL          0x00000002      // tratando uma interrupção
+#define SR_IM_SHIFT     8               // bits 8..15: máscara por linha (1 = habilitada)
+#define SR_DEFAULT      (SR_IE | (0xFF << SR_IM_SHIFT))
+
+// campos do registrador cr
+#define CR_CODE_SHIFT   2               // bits 2..6: linha que causou a interrupção
+#define CR_IP_SHIFT     8               // bits 8..15: linhas pendentes
+
+#define IRQ_HANDLER_CYCLES 8            // ciclos de kernel por interrupção tratada
+
+// Linhas de interrupção em ordem de prioridade (0 = mais prioritária).
+enum interruptLine {
+    IRQ_TIMER,
+    IRQ_DISK,
+    IRQ_CONSOLE,
+    IRQ_SLEEP,
+    IRQ_DMA,
+    NUM_IRQ_LINES
+};
+
+struct interruptEntry {
+    uint8_t line;
+    uint64_t raised;        // ciclo em que a interrupção foi levantada
+    ioRequest request;      // pedido concluído (interrupções de dispositivo)
+};
+
+// Controlador de interrupções de um núcleo. Os dispositivos levantam
+// interrupções de qualquer thread; somente o núcleo dono as atende, entre
+// um ciclo e outro do pipeline, respeitando a máscara e o bit IE do sr do
+// banco de registradores em uso. Ao atender, cr recebe a causa e epc o pc.
+struct INTERRUPT_CONTROLLER {
+    int core;
+    atomic<uint32_t> pendingMask;
+    PROFILED_MUTEX lock;
+    deque<interruptEntry> pending;
+
+    uint64_t timerDeadline;         // fim do quantum atual
+    REGISTER_BANK kernelRegisters;  // usado quando o núcleo está sem processo
+
+    // estatísticas, escritas somente pelo núcleo dono
+    uint64_t taken[NUM_IRQ_LINES];
+    uint64_t latencySum[NUM_IRQ_LINES];
+    uint64_t maxLatency[NUM_IRQ_LINES];
+    uint64_t kernelCycles;
+
+    INTERRUPT_CONTROLLER(int core);
+
+    void Raise(uint8_t line, uint64_t time, const ioRequest &request);
+    void ArmTimer(uint64_t deadline);
+    void DisarmTimer();
+    void Tick(uint64_t now);
+
+    bool Next(REGISTER_BANK &registers, uint64_t now, interruptEntry &entry);
+    void Return(REGISTER_BANK &registers, uint64_t cycles);
+
+    void PrintStats(ostream &out) const;
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include "PIPELINE_COUNTERS.h"
+
+#include <algorithm>
+#include <iomanip>
+
+void PIPELINE_COUNTERS::Add(cpiComponent component, uint64_t cycles){
+    stack[component] += cycles;
+}
+
+// Modelos de tempo: o primeiro ciclo até o commit conta como base, a latência
+// da própria operação como EX e o resto como o motivo da espera: o pipeline
+// enchendo (primeira instrução do quantum ou a primeira depois de um desvio)
+// ou o EX. Commits no mesmo ciclo da instrução anterior não custam ciclo.
+void PIPELINE_COUNTERS::Commit(uint64_t cycles, unsigned latency){
+    instructions += 1;
+    if(cycles > 0){
+        uint64_t execute = min<uint64_t>(cycles - 1, latency - 1);
+        stack[CPI_BASE] += 1;
+        stack[CPI_EXECUTE] += execute;
+        stack[instructions == 1 ? CPI_FETCH : refilling ? CPI_BRANCH : CPI_EXECUTE] += cycles - 1 - execute;
+    }
+    refilling = false;
+}
+
+void PIPELINE_COUNTERS::Flush(){
+    branchFlushes += 1;
+    refilling = true;
+}
+
+void PIPELINE_COUNTERS::Merge(const PIPELINE_COUNTERS &other){
+    for(int component = 0; component < NUM_CPI; component++){
+        stack[component] += other.stack[component];
+    }
+    instructions += other.instructions;
+    branchFlushes += other.branchFlushes;
+    quanta += other.quanta;
+    timerExits += other.timerExits;
+    ioBlockExits += other.ioBlockExits;
+    finished += other.finished;
+}
+
+uint64_t PIPELINE_COUNTERS::Cycles() const{
+    uint64_t cycles = 0;
+    for(uint64_t component : stack){
+        cycles += component;
+    }
+    return cycles;
+}
+
+void PIPELINE_COUNTERS::Print(ostream &out, const string &name) const{
+    static const char* componentNames[NUM_CPI] = {"base", "fetch", "branch", "execute", "memory", "drain", "interrupt"};
+    const uint64_t cycles = Cycles();
+
+    out << "[" << name << "] pipeline: " << cycles << " cycles, " << instructions << " instructions, CPI "
+        << fixed << setprecision(2) << (instructions ? (double)cycles / instructions : 0.0)
+        << ", " << quanta << " quanta (timer " << timerExits << ", I/O block " << ioBlockExits
+        << ", finished " << finished << "), " << branchFlushes << " branch flushes" << endl;
+    out << "  CPI stack:";
+    for(int component = 0; component < NUM_CPI; component++){
+        out << (component ? ", " : " ") << componentNames[component] << " "
+            << (instructions ? (double)stack[component] / instructions : 0.0)
+            << " (" << (cycles ? 100.0 * stack[component] / cycles : 0.0) << "%)";
+    }
+    out << endl;
+    out << "  stalls: IF " << stack[CPI_FETCH] + stack[CPI_BRANCH] << " cycles, EX " << stack[CPI_EXECUTE]
+        << ", MEM " << stack[CPI_MEMORY] << ", drain " << stack[CPI_DRAIN] << endl;
+    out << defaultfloat;
+}
@@ -0,0 +1,45 @@
+#ifndef PIPELINE_COUNTERS_H
+#define PIPELINE_COUNTERS_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+using namespace std;
+
+// Para onde vai cada ciclo de um núcleo. A soma das parcelas é o total de
+// ciclos com processo no núcleo, então dividida pelas instruções dá a pilha
+// de CPI.
+enum cpiComponent {
+    CPI_BASE,       // ciclos em que uma instrução passou pelo EX (ou foi confirmada)
+    CPI_FETCH,      // pipeline enchendo no início do quantum
+    CPI_BRANCH,     // pipeline enchendo de novo depois de um desvio tomado ou retorno mal previsto
+    CPI_EXECUTE,    // EX preso por operação longa ou, fora de ordem, esperando operandos e unidades
+    CPI_MEMORY,     // MEM preso por instrução vetorial
+    CPI_DRAIN,      // pipeline esvaziando no fim do quantum ou no bloqueio por E/S
+    CPI_INTERRUPT,  // tratadores de interrupção
+    NUM_CPI
+};
+
+// Contadores de ciclo a ciclo do pipeline, de um núcleo ou de um processo.
+// Core() conta um quantum em um objeto próprio e no fim soma nos do núcleo e
+// do processo.
+struct PIPELINE_COUNTERS {
+    uint64_t stack[NUM_CPI] = {};
+    uint64_t instructions = 0;      // passaram pelo EX (ou foram confirmadas)
+    uint64_t branchFlushes = 0;
+    uint64_t quanta = 0;
+    uint64_t timerExits = 0;        // saídas do núcleo pelo fim do quantum
+    uint64_t ioBlockExits = 0;      // ... por bloqueio em E/S, fila cheia ou dwait
+    uint64_t finished = 0;
+    bool refilling = false;         // desvio tomado ainda sem instrução nova confirmada
+
+    void Add(cpiComponent component, uint64_t cycles);
+    void Commit(uint64_t cycles, unsigned latency);    // confirmada `cycles` ciclos depois da anterior
+    void Flush();
+    void Merge(const PIPELINE_COUNTERS &other);
+    uint64_t Cycles() const;
+    void Print(ostream &out, const string &name) const;
+};
+
+#endif
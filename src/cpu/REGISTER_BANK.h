@@ -17,6 +17,7 @@ struct REGISTER_BANK {
     //registradores de uso especifico
     REGISTER pc, mar, cr, epc, sr;                      // program counter, memory address register, cause register, exception program counter, status register
     REGISTER hi, lo; 
+    REGISTER vl;                                        // vector length: elementos das instruções vetoriais
     REGISTER ir;                                   // registradores usados para armazenar os resultados de operações de multiplicação e divisão (resultado de 64 bits dividido em dois registradores de 32 bits)
     //registradores de uso geral
 
@@ -41,6 +42,7 @@ struct REGISTER_BANK {
         acessoLeituraRegistradores["epc"] = [this](){ return this->epc.read(); };
         acessoLeituraRegistradores["sr"] = [this](){ return this->sr.read(); };
         acessoLeituraRegistradores["lo"] = [this](){ return this->lo.read(); };
+        acessoLeituraRegistradores["vl"] = [this](){ return this->vl.read(); };
         acessoLeituraRegistradores["ir"] = [this](){ return this->ir.read(); };
         acessoLeituraRegistradores["zero"] = [this](){ return this->zero.read(); };
         acessoLeituraRegistradores["at"] = [this](){ return this->at.read(); };
@@ -82,6 +84,7 @@ struct REGISTER_BANK {
         acessoEscritaRegistradores["epc"] = [this](uint32_t val) { this->epc.value = val; };
         acessoEscritaRegistradores["sr"] = [this](uint32_t val) { this->sr.value = val; };
         acessoEscritaRegistradores["lo"] = [this](uint32_t val) { this->lo.value = val; };
+        acessoEscritaRegistradores["vl"] = [this](uint32_t val) { this->vl.value = val; };
         acessoEscritaRegistradores["ir"] = [this](uint32_t val) { this->ir.value = val; };
         acessoEscritaRegistradores["zero"] = [this](uint32_t val) { this->zero.value = val; };
         acessoEscritaRegistradores["at"] = [this](uint32_t val) { this->at.value = val; };
@@ -0,0 +1,28 @@
+#include "RETURN_ADDRESS_STACK.h"
+
+void RETURN_ADDRESS_STACK::Push(uint32_t address){
+    top = (top + 1) % RAS_DEPTH;
+    entries[top] = address;
+    if(depth < RAS_DEPTH){
+        depth += 1;
+    }
+}
+
+bool RETURN_ADDRESS_STACK::Pop(uint32_t &address){
+    if(depth == 0){
+        return false;
+    }
+    address = entries[top];
+    top = (top + RAS_DEPTH - 1) % RAS_DEPTH;
+    depth -= 1;
+    return true;
+}
+
+rasCheckpoint RETURN_ADDRESS_STACK::Save() const{
+    return rasCheckpoint{top, depth};
+}
+
+void RETURN_ADDRESS_STACK::Restore(const rasCheckpoint &checkpoint){
+    top = checkpoint.top;
+    depth = checkpoint.depth;
+}
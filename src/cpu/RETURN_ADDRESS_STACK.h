@@ -0,0 +1,29 @@
+#ifndef RETURN_ADDRESS_STACK_H
+#define RETURN_ADDRESS_STACK_H
+
+#include <cstdint>
+
+#define RAS_DEPTH 16
+
+struct rasCheckpoint {
+    int top;
+    int depth;
+};
+
+// Pilha circular de endereços de retorno usada pelo Fetch para prever o
+// destino de "jr $ra": jal empilha o endereço seguinte e jr $ra desempilha.
+// Cheia, a entrada mais antiga é sobrescrita. Quando um desvio descarta
+// instruções buscadas depois dele, o topo volta ao ponto salvo pelo desvio;
+// entradas sobrescritas pelo caminho errado não são recuperadas.
+struct RETURN_ADDRESS_STACK {
+    uint32_t entries[RAS_DEPTH];
+    int top = 0;
+    int depth = 0;          // entradas válidas
+
+    void Push(uint32_t address);
+    bool Pop(uint32_t &address);
+    rasCheckpoint Save() const;
+    void Restore(const rasCheckpoint &checkpoint);
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include "SUPERSCALAR.h"
+
+#include <algorithm>
+
+SUPERSCALAR::SUPERSCALAR(EXECUTION_UNITS &units, uint64_t now) : units(units), width(units.issueWidth){
+    groupIssue = now;
+    fetchCycle = now;
+    executeFree = now;
+    lastCommit = now;
+}
+
+SUPERSCALAR::~SUPERSCALAR(){
+    Close(NUM_SPLITS);
+}
+
+// Motivo para a instrução não entrar no grupo atual, NUM_SPLITS com o grupo
+// cheio, ou -1 quando ela entra.
+int SUPERSCALAR::Split(const scheduledOp &op, uint64_t fetch) const{
+    if(size == width){
+        return NUM_SPLITS;
+    }
+    if(serial || op.use.serializing){
+        return SPLIT_SERIAL;
+    }
+    if(taken){
+        return SPLIT_BRANCH;
+    }
+    if(fetch + 2 > groupIssue){
+        return SPLIT_FETCH;
+    }
+    auto inGroup = [this](const string &name){
+        return find(written.begin(), written.end(), name) != written.end();
+    };
+    for(int i = 0; i < op.sourceCount; i++){
+        if(inGroup(op.sources[i])){
+            return SPLIT_DEPENDENCY;
+        }
+    }
+    bool writes = !op.destination.empty() && op.destination != "zero";
+    if((writes && inGroup(op.destination))
+        || ((op.load || op.store) && find(stored.begin(), stored.end(), op.address) != stored.end())){
+        return SPLIT_DEPENDENCY;
+    }
+    if(used[op.use.unit] == units.config[op.use.unit].count){
+        return SPLIT_UNIT;
+    }
+    if(reads + op.sourceCount > READ_PORTS_PER_LANE * width || this->writes + writes > WRITE_PORTS_PER_LANE * width){
+        return SPLIT_PORTS;
+    }
+    return -1;
+}
+
+void SUPERSCALAR::Close(int reason){
+    if(size == 0){
+        return;
+    }
+    units.groups += 1;
+    units.groupSizes[size] += 1;
+    if(reason >= 0 && reason < NUM_SPLITS){
+        units.splits[reason] += 1;
+    }
+    size = 0;
+    fill(begin(used), end(used), 0);
+    reads = 0;
+    writes = 0;
+    written.clear();
+    stored.clear();
+    serial = false;
+    taken = false;
+}
+
+uint64_t SUPERSCALAR::Schedule(const scheduledOp &op){
+    const unitUse &use = op.use;
+
+    if(fetched == width){
+        fetchCycle += 1;
+        fetched = 0;
+    }
+    uint64_t fetch = fetchCycle;
+    fetched += 1;
+
+    int reason = size == 0 ? NUM_SPLITS : Split(op, fetch);
+    if(reason >= 0){
+        Close(reason);
+        groupIssue = max({groupIssue + 1, executeFree, fetch + 2});
+        if(fetchCycle + 2 < groupIssue){
+            // EX parado segura a busca: só o que cabe no decode fica buscado
+            fetchCycle = groupIssue - 2;
+            fetched = 1;
+        }
+    }
+
+    size += 1;
+    used[use.unit] += 1;
+    reads += op.sourceCount;
+    if(!op.destination.empty() && op.destination != "zero"){
+        writes += 1;
+        written.push_back(op.destination);
+    }
+    if(op.store){
+        stored.push_back(op.address);
+    }
+    serial = serial || use.serializing;
+    units.Record(use, 0);
+
+    // EX, MEM e WB; o grupo seguinte espera a operação mais lenta deste
+    executeFree = max(executeFree, groupIssue + use.latency);
+    lastCommit = max(lastCommit, groupIssue + use.latency + 1);
+    return lastCommit;
+}
+
+void SUPERSCALAR::Redirect(int){
+    taken = true;
+    fetchCycle = max(fetchCycle + 1, groupIssue);
+    fetched = 0;
+    units.redirects += 1;
+}
+
+void SUPERSCALAR::Stall(uint64_t now){
+    if(now > lastCommit){
+        Close(NUM_SPLITS);
+        lastCommit = now;
+        executeFree = max(executeFree, now);
+        if(now > fetchCycle){
+            fetchCycle = now;
+            fetched = 0;
+        }
+    }
+}
+
+uint64_t SUPERSCALAR::NextFetch(int) const{
+    return fetched == width ? fetchCycle + 1 : fetchCycle;
+}
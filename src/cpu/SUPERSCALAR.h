@@ -0,0 +1,53 @@
+#ifndef SUPERSCALAR_H
+#define SUPERSCALAR_H
+
+#include "EXECUTION_UNITS.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Modelo de tempo do pipeline em ordem com issueWidth > 1. A busca traz até
+// issueWidth palavras por ciclo e o decode junta instruções consecutivas em um
+// grupo que entra no EX no mesmo ciclo. Uma instrução fica para o grupo
+// seguinte quando lê ou escreve algo escrito no grupo, quando não sobra
+// unidade da sua classe ou porta do REGISTER_BANK, quando vem depois de um
+// desvio tomado ou quando precisa executar sozinha. Como no pipeline de 5
+// estágios, uma operação longa prende o EX: o grupo seguinte espera a mais
+// lenta do grupo atual, e um desvio tomado busca o destino no ciclo em que
+// executa.
+struct SUPERSCALAR : timingModel {
+    EXECUTION_UNITS &units;
+    const unsigned width;
+
+    // grupo em formação
+    uint64_t groupIssue;            // ciclo em que o grupo entra no EX
+    unsigned size = 0;
+    unsigned used[NUM_UNITS] = {};
+    unsigned reads = 0;
+    unsigned writes = 0;
+    vector<string> written;         // registradores escritos pelo grupo
+    vector<uint32_t> stored;        // endereços escritos pelo grupo
+    bool serial = false;
+    bool taken = false;
+
+    uint64_t fetchCycle;
+    unsigned fetched = 0;           // instruções já buscadas em fetchCycle
+    uint64_t executeFree;           // primeiro ciclo em que o EX aceita outro grupo
+    uint64_t lastCommit;
+
+    SUPERSCALAR(EXECUTION_UNITS &units, uint64_t now);
+    ~SUPERSCALAR();
+
+    uint64_t Schedule(const scheduledOp &op) override;
+    void Redirect(int thread) override;
+    void Stall(uint64_t now) override;
+    uint64_t NextFetch(int thread) const override;
+
+    int Split(const scheduledOp &op, uint64_t fetch) const;
+    void Close(int reason);
+};
+
+#endif
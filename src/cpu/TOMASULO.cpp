@@ -0,0 +1,155 @@
+#include "TOMASULO.h"
+
+#include <algorithm>
+
+// Primeiro ciclo a partir de `from` em que há capacidade por `cycles` ciclos
+// seguidos, já marcando a reserva.
+static uint64_t reserve(map<uint64_t, unsigned> &table, unsigned capacity, uint64_t from, unsigned cycles){
+    uint64_t start = from;
+    for(uint64_t cycle = start; cycle < start + cycles; cycle++){
+        auto entry = table.find(cycle);
+        if(entry != table.end() && entry->second >= capacity){
+            start = cycle + 1;
+        }
+    }
+    for(uint64_t cycle = start; cycle < start + cycles; cycle++){
+        table[cycle] += 1;
+    }
+    return start;
+}
+
+TOMASULO::TOMASULO(EXECUTION_UNITS &units, uint64_t now, unsigned contexts) : units(units), width(units.issueWidth){
+    for(int unit = 0; unit < NUM_UNITS; unit++){
+        stations[unit].assign(units.config[unit].stations, now);
+    }
+    threads.resize(contexts);
+    for(tomasuloThread &thread : threads){
+        thread.rob.resize(max(4u, ROB_SIZE / contexts));
+        thread.fetchCycle = now;
+        thread.lastFetch = now;
+        thread.lastDispatch = now;
+        thread.lastReady = now;
+        thread.lastCommit = now;
+    }
+}
+
+uint64_t TOMASULO::Schedule(const scheduledOp &op){
+    const unitUse &use = op.use;
+    tomasuloThread &thread = threads[op.thread];
+    const uint64_t tag = thread.nextTag++;
+    robEntry &slot = thread.rob[tag % thread.rob.size()];
+
+    // busca e decode de width instruções por ciclo, divididas entre os contextos
+    uint64_t fetch = reserve(fetches, width, thread.fetchCycle, 1);
+    for(size_t other = 0; other < threads.size(); other++){
+        if((int)other != op.thread && threads[other].fetchCycle > fetch){
+            units.contextFilled[op.thread] += 1;
+            break;
+        }
+    }
+    thread.fetchCycle = fetch;
+    thread.lastFetch = fetch;
+
+    uint64_t dispatch = max(fetch + 1, thread.lastDispatch);
+    if(slot.tag != 0 && slot.commit + 1 > dispatch){
+        units.robStalls += slot.commit + 1 - dispatch;
+        dispatch = slot.commit + 1;
+    }
+    auto station = min_element(stations[use.unit].begin(), stations[use.unit].end());
+    if(*station > dispatch){
+        units.stationStalls += *station - dispatch;
+        dispatch = *station;
+    }
+    dispatch = reserve(dispatches, width, dispatch, 1);
+    thread.lastDispatch = dispatch;
+    if(dispatch > fetch + 1){
+        // despacho parado segura a busca do contexto
+        thread.fetchCycle = max(thread.fetchCycle, dispatch - 1);
+    }
+
+    // operandos: do ROB se o produtor ainda não foi confirmado, senão do banco
+    uint64_t ready = dispatch + 1;
+    for(int i = 0; i < op.sourceCount; i++){
+        auto producer = thread.rat.find(op.sources[i]);
+        if(producer != thread.rat.end()){
+            const robEntry &entry = thread.rob[producer->second % thread.rob.size()];
+            if(entry.tag == producer->second){
+                ready = max(ready, entry.ready);
+            }
+        }
+    }
+    if(op.load){
+        auto store = stores.find(op.address);
+        if(store != stores.end()){
+            ready = max(ready, store->second);
+        }
+    }
+    if(use.serializing){
+        // efeitos fora dos registradores: só com as anteriores confirmadas
+        ready = max(ready, thread.lastCommit);
+    }
+
+    uint64_t issue = reserve(reserved[use.unit], units.config[use.unit].count, ready, use.occupancy);
+    *station = issue + 1;
+    uint64_t complete = reserve(broadcasts, width, issue + use.latency, 1);
+    uint64_t commit = reserve(commits, width, max(complete + 1, thread.lastCommit), 1);
+
+    slot = robEntry{tag, complete, commit};
+    if(!op.destination.empty() && op.destination != "zero"){
+        thread.rat[op.destination] = tag;
+    }
+    if(op.store){
+        stores[op.address] = complete;
+    }
+    thread.inFlight.push_back(commit);
+    while(thread.inFlight.size() > thread.rob.size()){
+        thread.inFlight.pop_front();
+    }
+    units.Record(use, op.thread);
+
+    // nenhuma instrução mais nova é buscada ou emitida antes do último
+    // despacho do seu contexto
+    uint64_t horizon = dispatch;
+    for(const tomasuloThread &other : threads){
+        horizon = min(horizon, min(other.fetchCycle, other.lastDispatch));
+    }
+    for(auto *table : {&fetches, &dispatches, &broadcasts, &commits}){
+        table->erase(table->begin(), table->lower_bound(horizon));
+    }
+    for(auto &table : reserved){
+        table.erase(table.begin(), table.lower_bound(horizon));
+    }
+    if(stores.size() > 256){
+        erase_if(stores, [horizon](const auto &entry){ return entry.second <= horizon; });
+    }
+
+    thread.lastReady = complete;
+    thread.lastCommit = commit;
+    return commit;
+}
+
+// Desvio tomado ou retorno mal previsto: as instruções buscadas depois dele
+// são descartadas e o fetch recomeça no ciclo seguinte ao que ele executou.
+void TOMASULO::Redirect(int id){
+    tomasuloThread &thread = threads[id];
+    thread.fetchCycle = max(thread.lastFetch + 1, thread.lastReady);
+    units.redirects += 1;
+}
+
+void TOMASULO::Stall(uint64_t now){
+    for(tomasuloThread &thread : threads){
+        thread.lastCommit = max(thread.lastCommit, now);
+        thread.fetchCycle = max(thread.fetchCycle, now);
+    }
+}
+
+uint64_t TOMASULO::NextFetch(int id) const{
+    const tomasuloThread &thread = threads[id];
+    auto used = fetches.find(thread.fetchCycle);
+    return used != fetches.end() && used->second >= width ? thread.fetchCycle + 1 : thread.fetchCycle;
+}
+
+unsigned TOMASULO::InFlight(int id, uint64_t cycle) const{
+    const deque<uint64_t> &inFlight = threads[id].inFlight;
+    return count_if(inFlight.begin(), inFlight.end(), [cycle](uint64_t commit){ return commit > cycle; });
+}
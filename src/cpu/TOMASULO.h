@@ -0,0 +1,70 @@
+#ifndef TOMASULO_H
+#define TOMASULO_H
+
+#include "EXECUTION_UNITS.h"
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define ROB_SIZE 16
+
+struct robEntry {
+    uint64_t tag = 0;       // número de sequência da instrução (0 = livre)
+    uint64_t ready = 0;     // ciclo em que o resultado passa no barramento comum
+    uint64_t commit = 0;
+};
+
+// Estado de um contexto de hardware: a sua parte do ROB, a renomeação dos
+// seus registradores e onde estão a sua busca e o seu commit.
+struct tomasuloThread {
+    vector<robEntry> rob;
+    uint64_t nextTag = 1;
+    unordered_map<string, uint64_t> rat;    // registrador -> tag do último produtor
+    deque<uint64_t> inFlight;               // ciclos de commit das buscadas e não confirmadas
+    uint64_t fetchCycle;                    // primeiro ciclo em que pode buscar
+    uint64_t lastFetch;
+    uint64_t lastDispatch;
+    uint64_t lastReady;
+    uint64_t lastCommit;
+};
+
+// Modelo de tempo do núcleo fora de ordem. Para cada instrução o modelo decide
+// quando é despachada (com entrada livre no ROB e estação de reserva na sua
+// unidade), quando é emitida (operandos prontos e unidade livre), quando o
+// resultado passa no barramento comum e quando é confirmada, sempre em ordem.
+// Busca, despacho, barramento e commit tratam issueWidth instruções por ciclo.
+// A renomeação aponta cada registrador do REGISTER_BANK para a entrada do ROB
+// que vai escrevê-lo, então só dependências verdadeiras atrasam a emissão.
+// Loads esperam só o último store anterior ao mesmo endereço.
+//
+// Com SMT cada contexto tem a sua renomeação e uma parte fixa do ROB, e as
+// vagas de busca, despacho, barramento e commit de cada ciclo são divididas
+// entre eles: um contexto parado em um desvio deixa as suas para os outros.
+struct TOMASULO : timingModel {
+    EXECUTION_UNITS &units;
+    const unsigned width;
+    vector<tomasuloThread> threads;
+    vector<uint64_t> stations[NUM_UNITS];           // ciclo em que cada estação fica livre
+    map<uint64_t, unsigned> reserved[NUM_UNITS];    // unidades ocupadas em cada ciclo
+    map<uint64_t, unsigned> fetches;                // vagas usadas em cada ciclo, por estágio
+    map<uint64_t, unsigned> dispatches;
+    map<uint64_t, unsigned> broadcasts;
+    map<uint64_t, unsigned> commits;
+    unordered_map<uint32_t, uint64_t> stores;       // endereço -> ciclo em que o store tem o dado
+
+    TOMASULO(EXECUTION_UNITS &units, uint64_t now, unsigned contexts = 1);
+
+    uint64_t Schedule(const scheduledOp &op) override;
+    void Redirect(int thread) override;
+    void Stall(uint64_t now) override;
+    uint64_t NextFetch(int thread) const override;
+    unsigned InFlight(int thread, uint64_t cycle) const;
+};
+
+#endif
@@ -0,0 +1,138 @@
+#include "VECTOR_UNIT.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_X86
+#endif
+
+typedef void (*binaryKernel)(vectorOperation, const uint32_t*, const uint32_t*, uint32_t*, size_t);
+typedef uint32_t (*sumKernel)(const uint32_t*, size_t);
+
+static void binaryScalar(vectorOperation op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count){
+    for(size_t i = 0; i < count; i++){
+        switch(op){
+            case VEC_ADD: out[i] = a[i] + b[i]; break;
+            case VEC_SUB: out[i] = a[i] - b[i]; break;
+            case VEC_MUL: out[i] = a[i] * b[i]; break;
+            case VEC_CMP: out[i] = a[i] == b[i]; break;
+        }
+    }
+}
+
+static uint32_t sumScalar(const uint32_t *a, size_t count){
+    uint32_t sum = 0;
+    for(size_t i = 0; i < count; i++){
+        sum += a[i];
+    }
+    return sum;
+}
+
+#ifdef VECTOR_X86
+
+__attribute__((target("avx2")))
+static void binaryAVX2(vectorOperation op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count){
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i r;
+        switch(op){
+            case VEC_ADD: r = _mm256_add_epi32(x, y); break;
+            case VEC_SUB: r = _mm256_sub_epi32(x, y); break;
+            case VEC_MUL: r = _mm256_mullo_epi32(x, y); break;
+            default:      r = _mm256_and_si256(_mm256_cmpeq_epi32(x, y), one); break;
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+    binaryScalar(op, a + i, b + i, out + i, count - i);
+}
+
+__attribute__((target("avx2")))
+static uint32_t sumAVX2(const uint32_t *a, size_t count){
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        acc = _mm256_add_epi32(acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(half) + sumScalar(a + i, count - i);
+}
+
+__attribute__((target("sse4.1")))
+static void binarySSE41(vectorOperation op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count){
+    const __m128i one = _mm_set1_epi32(1);
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        __m128i r;
+        switch(op){
+            case VEC_ADD: r = _mm_add_epi32(x, y); break;
+            case VEC_SUB: r = _mm_sub_epi32(x, y); break;
+            case VEC_MUL: r = _mm_mullo_epi32(x, y); break;
+            default:      r = _mm_and_si128(_mm_cmpeq_epi32(x, y), one); break;
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), r);
+    }
+    binaryScalar(op, a + i, b + i, out + i, count - i);
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t sumSSE41(const uint32_t *a, size_t count){
+    __m128i acc = _mm_setzero_si128();
+    size_t i = 0;
+    for(; i + 4 <= count; i += 4){
+        acc = _mm_add_epi32(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return (uint32_t)_mm_cvtsi128_si32(acc) + sumScalar(a + i, count - i);
+}
+
+#endif
+
+struct vectorBackend {
+    binaryKernel binary;
+    sumKernel sum;
+    const char *name;
+};
+
+static vectorBackend selectBackend(){
+#ifdef VECTOR_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2")){
+        return vectorBackend{binaryAVX2, sumAVX2, "avx2"};
+    }
+    if(__builtin_cpu_supports("sse4.1")){
+        return vectorBackend{binarySSE41, sumSSE41, "sse4.1"};
+    }
+#endif
+    return vectorBackend{binaryScalar, sumScalar, "scalar"};
+}
+
+static const vectorBackend backend = selectBackend();
+
+// Saída que começa dentro de um operando, depois do início dele: em blocos o
+// kernel leria elementos que a ordem elemento a elemento já teria escrito.
+static bool overlapsAhead(const uint32_t *in, const uint32_t *out, size_t count){
+    return out > in && out < in + count;
+}
+
+void VectorBinary(vectorOperation op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count){
+    if(overlapsAhead(a, out, count) || overlapsAhead(b, out, count)){
+        binaryScalar(op, a, b, out, count);
+        return;
+    }
+    backend.binary(op, a, b, out, count);
+}
+
+uint32_t VectorSum(const uint32_t *a, size_t count){
+    return backend.sum(a, count);
+}
+
+const char* VectorBackend(){
+    return backend.name;
+}
@@ -0,0 +1,24 @@
+#ifndef VECTOR_UNIT_H
+#define VECTOR_UNIT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#define VECTOR_LANES 8      // palavras de 32 bits processadas por ciclo simulado (256 bits)
+
+enum vectorOperation {
+    VEC_ADD,
+    VEC_SUB,
+    VEC_MUL,
+    VEC_CMP     // 1 onde os elementos são iguais, 0 onde diferem
+};
+
+// Kernels do host usados pelas instruções vetoriais. A implementação é
+// escolhida uma vez, pela CPU do host: AVX2, SSE4.1 ou laço escalar. Todas
+// dão o mesmo resultado, inclusive com operandos sobrepostos, em que o
+// resultado é o da ordem elemento a elemento.
+void VectorBinary(vectorOperation op, const uint32_t *a, const uint32_t *b, uint32_t *out, size_t count);
+uint32_t VectorSum(const uint32_t *a, size_t count);
+const char* VectorBackend();
+
+#endif
@@ -0,0 +1,127 @@
+#include "IO_QUEUE.h"
+
+static void UpdateMax(atomic<uint64_t> &target, uint64_t value)
+{
+    uint64_t current = target.load(memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, memory_order_relaxed)) {
+    }
+}
+
+IO_QUEUE::IO_QUEUE(size_t requestedCapacity)
+    : enqueuePos(0), dequeuePos(0), pushed(0), popped(0), fullRejects(0), depthSum(0),
+      maxDepth(0), completed(0), latencySum(0), maxLatency(0)
+{
+    // a capacidade é arredondada para potência de 2 para usar máscara no índice
+    capacity = 2;
+    while (capacity < requestedCapacity) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+
+    slots = make_unique<Slot[]>(capacity);
+    for (size_t i = 0; i < capacity; i++) {
+        slots[i].sequence.store(i, memory_order_relaxed);
+    }
+}
+
+bool IO_QUEUE::TryPush(const ioRequest &req)
+{
+    size_t pos = enqueuePos.load(memory_order_relaxed);
+    Slot *slot;
+
+    while (true) {
+        slot = &slots[pos & mask];
+        size_t seq = slot->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // fila cheia
+            fullRejects.fetch_add(1, memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(memory_order_relaxed);
+        }
+    }
+
+    slot->request = req;
+    slot->sequence.store(pos + 1, memory_order_release);
+
+    uint64_t depth = pos + 1 - dequeuePos.load(memory_order_relaxed);
+    pushed.fetch_add(1, memory_order_relaxed);
+    depthSum.fetch_add(depth, memory_order_relaxed);
+    UpdateMax(maxDepth, depth);
+    return true;
+}
+
+bool IO_QUEUE::TryPop(ioRequest &req)
+{
+    size_t pos = dequeuePos.load(memory_order_relaxed);
+    Slot *slot;
+
+    while (true) {
+        slot = &slots[pos & mask];
+        size_t seq = slot->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // fila vazia
+            return false;
+        } else {
+            pos = dequeuePos.load(memory_order_relaxed);
+        }
+    }
+
+    req = slot->request;
+    slot->sequence.store(pos + capacity, memory_order_release);
+    popped.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+size_t IO_QUEUE::Size() const
+{
+    size_t tail = enqueuePos.load(memory_order_acquire);
+    size_t head = dequeuePos.load(memory_order_acquire);
+    return tail >= head ? tail - head : 0;
+}
+
+bool IO_QUEUE::Empty() const
+{
+    return Size() == 0;
+}
+
+bool IO_QUEUE::Full() const
+{
+    return Size() >= capacity;
+}
+
+void IO_QUEUE::RecordCompletion(const ioRequest &req, uint64_t now)
+{
+    uint64_t latency = now - req.issued;
+    completed.fetch_add(1, memory_order_relaxed);
+    latencySum.fetch_add(latency, memory_order_relaxed);
+    UpdateMax(maxLatency, latency);
+}
+
+void IO_QUEUE::PrintStats(ostream &out) const
+{
+    uint64_t nPushed = pushed.load();
+    uint64_t nCompleted = completed.load();
+    double avgDepth = nPushed ? (double)depthSum.load() / nPushed : 0.0;
+    double avgLatency = nCompleted ? (double)latencySum.load() / nCompleted : 0.0;
+
+    out << "IO queue: capacity " << capacity
+        << ", pushed " << nPushed
+        << ", popped " << popped.load()
+        << ", full rejects " << fullRejects.load() << endl;
+    out << "IO queue depth: avg " << avgDepth << ", max " << maxDepth.load() << endl;
+    out << "IO latency: avg " << avgLatency << " cycles, max "
+        << maxLatency.load() << " cycles (" << nCompleted << " completed)" << endl;
+}
@@ -0,0 +1,76 @@
+#ifndef IO_QUEUE_H
+#define IO_QUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+struct PCB;
+
+enum ioOperation {
+    IO_PRINT,
+    IO_DISK_READ,
+    IO_DISK_WRITE,
+    IO_SLEEP,
+    IO_DMA_COPY,
+    IO_DMA_FILL
+};
+
+// Pedido de E/S emitido por uma instrução do processo (ex.: print).
+// Não possui membros alocados dinamicamente: copiar um pedido para dentro
+// da fila não gera alocação.
+struct ioRequest {
+    uint32_t value;         // valor impresso/gravado, lido do disco, origem ou valor do DMA
+    uint32_t arg;           // bloco do disco, duração do sleep ou destino do DMA
+    uint8_t op;             // ioOperation
+    uint8_t device;         // deviceId
+    uint8_t targetRegister; // código do registrador que recebe o dado lido
+    PCB* process = nullptr;
+    uint64_t issued = 0;    // ciclo virtual em que o pedido foi emitido
+    uint32_t length = 0;    // palavras de uma transferência de DMA
+};
+
+// Fila circular limitada, lock-free, com múltiplos produtores e múltiplos
+// consumidores (algoritmo de Vyukov). Cada slot carrega um número de
+// sequência que diz se ele está livre para o produtor (seq == pos) ou
+// pronto para o consumidor (seq == pos + 1). Os slots são alocados uma
+// única vez na construção.
+struct IO_QUEUE {
+    struct Slot {
+        atomic<size_t> sequence;
+        ioRequest request;
+    };
+
+    unique_ptr<Slot[]> slots;
+    size_t capacity;
+    size_t mask;
+
+    alignas(64) atomic<size_t> enqueuePos;
+    alignas(64) atomic<size_t> dequeuePos;
+
+    // estatísticas
+    alignas(64) atomic<uint64_t> pushed;
+    atomic<uint64_t> popped;
+    atomic<uint64_t> fullRejects;
+    atomic<uint64_t> depthSum;
+    atomic<uint64_t> maxDepth;
+    atomic<uint64_t> completed;
+    atomic<uint64_t> latencySum;     // em ciclos
+    atomic<uint64_t> maxLatency;
+
+    IO_QUEUE(size_t requestedCapacity);
+
+    bool TryPush(const ioRequest &req);
+    bool TryPop(ioRequest &req);
+    size_t Size() const;
+    bool Empty() const;
+    bool Full() const;
+
+    void RecordCompletion(const ioRequest &req, uint64_t now);
+    void PrintStats(ostream &out) const;
+};
+
+#endif
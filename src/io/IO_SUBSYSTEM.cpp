@@ -0,0 +1,310 @@
+#include "IO_SUBSYSTEM.h"
+#include "../PCB.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+DEVICE::DEVICE(string name, uint8_t line, size_t queueSize, unsigned serviceTime, unsigned parallelism)
+    : name(name), line(line), queue(queueSize), serviceTime(serviceTime), parallelism(parallelism),
+      busy(0), busyCycles(0)
+{
+}
+
+bool DEVICE::Busy() const
+{
+    return busy.load() >= parallelism;
+}
+
+uint64_t DEVICE::ServiceCycles(const ioRequest &req) const
+{
+    if (req.op == IO_SLEEP) {
+        return (uint64_t)serviceTime * req.arg;
+    }
+    if (req.op == IO_DMA_COPY || req.op == IO_DMA_FILL) {
+        return serviceTime + (req.length + DMA_WORDS_PER_CYCLE - 1) / DMA_WORDS_PER_CYCLE;
+    }
+    return serviceTime;
+}
+
+IO_SUBSYSTEM::IO_SUBSYSTEM(SECONDARY_MEMORY &disk, size_t queueSize)
+    : disk(disk), info(nullptr), clock(nullptr), staging(false)
+{
+    devices.push_back(make_unique<DEVICE>("console", IRQ_CONSOLE, queueSize, 1000, 1));
+    devices.push_back(make_unique<DEVICE>("disk", IRQ_DISK, queueSize, 200, 2));
+    devices.push_back(make_unique<DEVICE>("timer", IRQ_SLEEP, queueSize, 10, 4));
+    devices.push_back(make_unique<DEVICE>("dma", IRQ_DMA, queueSize, 20, 1));
+
+    devices[CONSOLE]->service = [](ioRequest &req) {
+        cout << "Program " << req.process->id << ": " << req.value << std::endl;
+    };
+
+    devices[DISK]->service = [this](ioRequest &req) {
+        if (req.op == IO_DISK_WRITE) {
+            this->disk.write(req.arg, req.value);
+        } else {
+            req.value = this->disk.read(req.arg);
+        }
+    };
+
+    devices[TIMER]->service = [](ioRequest &) {
+    };
+
+    devices[DMA]->service = [this](ioRequest &req) {
+        Transfer(req);
+    };
+}
+
+DEVICE* IO_SUBSYSTEM::FindDevice(const string &name)
+{
+    for (auto &device : devices) {
+        if (device->name == name) {
+            return device.get();
+        }
+    }
+    return nullptr;
+}
+
+bool IO_SUBSYSTEM::Submit(const ioRequest &req, int core)
+{
+    if (!staging) {
+        return devices[req.device]->queue.TryPush(req);
+    }
+
+    // durante a janela a fila não muda, então a decisão só depende deste núcleo
+    IO_QUEUE &queue = devices[req.device]->queue;
+    size_t pending = queue.Size();
+    for (const ioRequest &other : staged[core]) {
+        pending += other.device == req.device;
+    }
+    if (pending >= queue.capacity) {
+        queue.fullRejects += 1;
+        return false;
+    }
+    staged[core].push_back(req);
+    return true;
+}
+
+void IO_SUBSYSTEM::EnableStaging(int numCores)
+{
+    staging = true;
+    staged.assign(numCores, {});
+}
+
+// Chamada na barreira, com os núcleos parados. Pedidos que não couberem
+// (núcleos diferentes podem ter contado o mesmo espaço livre) ficam para a
+// próxima barreira, na mesma ordem.
+void IO_SUBSYSTEM::FlushStaged()
+{
+    vector<ioRequest> pending;
+    pending.swap(overflow);
+    for (auto &requests : staged) {
+        pending.insert(pending.end(), requests.begin(), requests.end());
+        requests.clear();
+    }
+
+    for (const ioRequest &req : pending) {
+        if (!overflow.empty() || !devices[req.device]->queue.TryPush(req)) {
+            overflow.push_back(req);
+        }
+    }
+}
+
+bool IO_SUBSYSTEM::Idle() const
+{
+    for (const auto &device : devices) {
+        if (!device->queue.Empty() || device->busy.load() > 0) {
+            return false;
+        }
+    }
+    return overflow.empty();
+}
+
+void IO_SUBSYSTEM::Start(scheduleInfo *info, SIM_CLOCK *clock)
+{
+    this->info = info;
+    this->clock = clock;
+    for (auto &device : devices) {
+        device->units.assign(device->parallelism, deviceUnit{device.get(), false, {}, 0});
+    }
+}
+
+// Executada pela thread do relógio: entrega a cada unidade livre o próximo
+// pedido da fila e agenda o evento de conclusão no tempo virtual.
+void IO_SUBSYSTEM::Dispatch()
+{
+    for (auto &device : devices) {
+        for (auto &unit : device->units) {
+            if (unit.busy || !device->queue.TryPop(unit.request)) {
+                continue;
+            }
+            unit.busy = true;
+            device->busy += 1;
+
+            {
+                // a retirada liberou espaço na fila
+                profiledGuard lock(*info->queueLock);
+                WakeProcesses(clock->now);
+            }
+
+            uint64_t start = max(clock->now.load(), unit.request.issued);
+            unit.start = start;
+            uint64_t cycles = device->ServiceCycles(unit.request);
+            device->busyCycles += cycles;
+
+            deviceUnit *pending = &unit;
+            uint64_t done = start + cycles;
+            clock->Schedule(done, [this, pending, done]() { Complete(*pending, done); });
+        }
+    }
+}
+
+// Conclusão no tempo virtual: o efeito do pedido acontece aqui e o núcleo
+// responsável pelo processo recebe a interrupção que vai acordá-lo.
+void IO_SUBSYSTEM::Complete(deviceUnit &unit, uint64_t now)
+{
+    DEVICE &device = *unit.device;
+    ioRequest &req = unit.request;
+
+    device.service(req);
+    device.queue.RecordCompletion(req, now);
+
+    if (req.device == DMA) {
+        // parte do serviço antes de o processo parar em dwait
+        PCB &pcb = *req.process;
+        uint64_t overlapEnd = pcb.waitingDMA ? clamp(pcb.dmaWaitStart.load(), unit.start, now) : now;
+        dmaOverlapCycles += overlapEnd - unit.start;
+    }
+
+    auto &interrupts = info->interrupts;
+    interrupts[req.process->id % interrupts.size()]->Raise(device.line, now, req);
+
+    unit.busy = false;
+    device.busy -= 1;
+}
+
+// Tratador da interrupção de dispositivo, executado pelo núcleo que a recebeu.
+void IO_SUBSYSTEM::HandleCompletion(const ioRequest &req, uint64_t time)
+{
+    profiledGuard lock(*info->queueLock);
+    if (req.op == IO_DISK_READ) {
+        // o processo está bloqueado esperando este valor
+        string name = registerNames.mp[bitset<5>(req.targetRegister).to_string()];
+        req.process->regBank.acessoEscritaRegistradores[name](req.value);
+    }
+    if (req.op == IO_DMA_COPY || req.op == IO_DMA_FILL) {
+        req.process->pendingDMA -= 1;
+    }
+    req.process->pendingIO -= 1;
+    WakeProcess(*req.process, time);
+}
+
+bool IO_SUBSYSTEM::WaitPending(const PCB &pcb) const
+{
+    if (pcb.waitingIO && pcb.pendingIO > 0) {
+        return true;
+    }
+    if (pcb.waitingIOSpace >= 0 && devices[pcb.waitingIOSpace]->queue.Full()) {
+        return true;
+    }
+    if (pcb.waitingDMA && pcb.pendingDMA > 0) {
+        return true;
+    }
+    return false;
+}
+
+void IO_SUBSYSTEM::Release(PCB &pcb, uint64_t time)
+{
+    pcb.waitingDMA = false;
+    pcb.waitingIO = false;
+    pcb.waitingIOSpace = -1;
+    pcb.readyTime = max(pcb.readyTime, time);
+    pcb.state = State::Ready;
+}
+
+void IO_SUBSYSTEM::WakeProcess(PCB &pcb, uint64_t time)
+{
+    if (pcb.state == State::Blocked && !WaitPending(pcb)) {
+        Release(pcb, time);
+    }
+}
+
+void IO_SUBSYSTEM::WakeProcesses(uint64_t time)
+{
+    for (auto &pcb : *info->processes) {
+        WakeProcess(*pcb, time);
+    }
+}
+
+void IO_SUBSYSTEM::PrintStats(ostream &out) const
+{
+    for (const auto &device : devices) {
+        out << "[" << device->name << "] service " << device->serviceTime << " cycles, parallelism "
+            << device->parallelism << ", busy " << device->busyCycles.load() << " cycles" << endl;
+        device->queue.PrintStats(out);
+    }
+
+    // banda por ciclo em que o DMA esteve ocupado; sobreposição é a parte
+    // desse tempo em que o processo seguiu executando em vez de esperar em dwait
+    const DEVICE &dma = *devices[DMA];
+    uint64_t busy = dma.busyCycles.load();
+    if (busy > 0) {
+        out << "[dma] " << dma.queue.completed.load() << " transfers, " << dmaWords.load() << " words, "
+            << (double)dmaWords.load() / busy << " words/cycle, overlap "
+            << 100.0 * dmaOverlapCycles.load() / busy << "% (" << dmaOverlapCycles.load() << " of "
+            << busy << " busy cycles)" << endl;
+    }
+}
+
+// Transferência de DMA sobre a RAM, uma faixa de linha da MainMemory por vez,
+// com memmove/memset do host. Com origem e destino sobrepostos o destino
+// recebe a origem como era antes da cópia, como no memmove.
+void IO_SUBSYSTEM::Transfer(const ioRequest &req)
+{
+    MainMemory &ram = *info->ram;
+    const bool copy = req.op == IO_DMA_COPY;
+    const uint32_t source = req.value;
+    const uint32_t target = req.arg;
+    const size_t count = req.length;
+
+    vector<uint32_t> buffer;
+    if (copy && source < target && target < source + count) {
+        // o destino começa dentro da origem: lê toda a origem antes de escrever
+        buffer.resize(count);
+        size_t done = 0;
+        while (done < count) {
+            size_t run;
+            const uint32_t *from = ram.Words(source + done, run);
+            if (from == nullptr) {
+                break;
+            }
+            run = min(run, count - done);
+            memcpy(buffer.data() + done, from, run * sizeof(uint32_t));
+            done += run;
+        }
+    }
+
+    size_t done = 0;
+    while (done < count) {
+        size_t run, sourceRun = count;
+        uint32_t *to = ram.Words(target + done, run);
+        const uint32_t *from = nullptr;
+        if (copy) {
+            from = buffer.empty() ? ram.Words(source + done, sourceRun) : buffer.data() + done;
+        }
+        if (to == nullptr || (copy && from == nullptr)) {
+            cerr << "DMA: endereço inválido (" << source << " -> " << target << ", " << count << " palavras)" << endl;
+            break;
+        }
+        run = min({run, sourceRun, count - done});
+        if (copy) {
+            memmove(to, from, run * sizeof(uint32_t));
+        } else if (req.value == 0) {
+            memset(to, 0, run * sizeof(uint32_t));
+        } else {
+            fill_n(to, run, req.value);
+        }
+        done += run;
+    }
+    dmaWords += done;
+}
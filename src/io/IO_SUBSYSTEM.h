@@ -0,0 +1,97 @@
+#ifndef IO_SUBSYSTEM_H
+#define IO_SUBSYSTEM_H
+
+#include "IO_QUEUE.h"
+#include "../cpu/HashRegister.h"
+#include "../memory/SECONDARY_MEMORY.h"
+#include "../sim/SIM_CLOCK.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct scheduleInfo;
+struct DEVICE;
+
+enum deviceId {
+    CONSOLE,
+    DISK,
+    TIMER,
+    DMA,
+    NUM_DEVICES
+};
+
+#define DMA_WORDS_PER_CYCLE 4       // banda do DMA depois do custo fixo (serviceTime)
+
+// Uma unidade de atendimento do dispositivo: guarda o pedido em serviço
+// até o evento de conclusão disparar.
+struct deviceUnit {
+    DEVICE *device;
+    bool busy;
+    ioRequest request;
+    uint64_t start;         // ciclo em que o serviço começou
+};
+
+// Dispositivo simulado: cada um tem a sua própria fila, o seu tempo de
+// serviço (em ciclos) e o número de pedidos que consegue atender ao mesmo
+// tempo. Um pedido só sai da fila quando uma unidade fica livre.
+struct DEVICE {
+    string name;
+    uint8_t line;                   // linha de interrupção levantada na conclusão
+    IO_QUEUE queue;
+    unsigned serviceTime;           // ciclos por pedido (por unidade de tempo no timer)
+    unsigned parallelism;
+    vector<deviceUnit> units;
+    atomic<unsigned> busy;
+    atomic<uint64_t> busyCycles;
+    function<void(ioRequest&)> service;
+
+    DEVICE(string name, uint8_t line, size_t queueSize, unsigned serviceTime, unsigned parallelism);
+
+    bool Busy() const;
+    uint64_t ServiceCycles(const ioRequest &req) const;
+};
+
+struct IO_SUBSYSTEM {
+    SECONDARY_MEMORY &disk;
+    vector<unique_ptr<DEVICE>> devices;
+    scheduleInfo *info;
+    SIM_CLOCK *clock;
+    Map registerNames;
+
+    // modo determinístico: os pedidos de cada núcleo ficam retidos durante a
+    // janela e entram nas filas na barreira, sempre na ordem dos núcleos
+    bool staging;
+    vector<vector<ioRequest>> staged;
+    vector<ioRequest> overflow;
+
+    atomic<uint64_t> dmaWords{0};           // palavras copiadas ou preenchidas
+    atomic<uint64_t> dmaOverlapCycles{0};   // ciclos de DMA com o processo ainda executando
+
+    IO_SUBSYSTEM(SECONDARY_MEMORY &disk, size_t queueSize);
+
+    DEVICE* FindDevice(const string &name);
+    bool Submit(const ioRequest &req, int core);
+    void EnableStaging(int numCores);
+    void FlushStaged();
+    bool Idle() const;
+
+    void Start(scheduleInfo *info, SIM_CLOCK *clock);
+    void Dispatch();
+    void Complete(deviceUnit &unit, uint64_t now);
+    void HandleCompletion(const ioRequest &req, uint64_t time);
+    void Transfer(const ioRequest &req);
+
+    // devem ser chamadas com queueLock adquirido
+    bool WaitPending(const PCB &pcb) const;
+    void Release(PCB &pcb, uint64_t time);
+    void WakeProcess(PCB &pcb, uint64_t time);
+    void WakeProcesses(uint64_t time);
+
+    void PrintStats(ostream &out) const;
+};
+
+#endif
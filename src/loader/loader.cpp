@@ -1,130 +1,141 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
-#include <unordered_map>
 #include <vector>
-#include <bitset>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include"../memory/MAINMEMORY.h"
 #include"./loader.h"
+#include"./object.h"
 
 const int MEMORY_SIZE = 2048*2048; // 32-bit address space
 
-std::string padName(const std::string& name) {
-    return name + std::string(16 - name.length(), '#');
+static uint32_t get32(const uint8_t *p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t get16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+// Copia um segmento de palavras little-endian do arquivo para a RAM.
+static void copySegment(MainMemory & ram, uint32_t address, const uint8_t *words, uint32_t count) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    // o arquivo já está na ordem da máquina e o mmap é alinhado à página
+    ram.WriteBlock(address, reinterpret_cast<const uint32_t*>(words), count);
+#else
+    std::vector<uint32_t> native(count);
+    for (uint32_t i = 0; i < count; i++) {
+        native[i] = get32(words + 4 * i);
+    }
+    ram.WriteBlock(address, native.data(), count);
+#endif
 }
 
-int loadProgram(std::string inputFile, MainMemory & ram, int initialAddress) {
+int loadProgram(std::string inputFile, MainMemory & ram, int initialAddress, programLayout &layout) {
     inputFile = "programs/" + inputFile + ".bin";
-    std::ifstream file(inputFile);
-    
-    if (!file.is_open()) {
+    int fd = open(inputFile.c_str(), O_RDONLY);
+
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
         std::cerr << "Error opening file!" << std::endl;
         exit(1);
     }
 
-    std::unordered_map<std::string, int> labelAddresses;
-    std::unordered_map<std::string, int> variableAddresses;
-    std::vector<std::string> instructions;
-    int address = initialAddress; 
-
-    std::string line;
-
-    // Read instructions and data
-    while (std::getline(file, line)) {
-      std::string trimmedLine = line;
-      trimmedLine.erase(trimmedLine.find_last_not_of(" \n\r\t") + 1);
-        
-        // data section
-        if (trimmedLine.find(".data") != std::string::npos) {
-            while (std::getline(file, line)) {
-                std::istringstream dataStream(line);
-                std::string variableName;
-                std::string values;
-                std::string value;
-
-              // Extract variable name and value from the format "var: value"
-              if (dataStream >> variableName) {
-                size_t colonPos = variableName.find(':');
-                if (colonPos != std::string::npos) {
-                    variableName = variableName.substr(0, colonPos); 
-                    variableAddresses[padName(variableName)] = address;
-
-                    std::getline(dataStream, values);
-                    std::istringstream valueStream(values);
-
-                    while (std::getline(valueStream, value, ',')) {
-                        if (address >= MEMORY_SIZE) {
-                            std::cerr << "Memory overflow while allocating vector data." << std::endl;
-                            exit(1);
-                        }
-                        // Convert the value to int and store it in memory
-                        int intValue = std::stoi(value);
-                        ram.WriteMem(address,intValue);
-
-                        //std::cout << "Variable: " << padName(variableName) 
-                        //          << " Address: " << address 
-                        //          << " Value: " << intValue << std::endl;
-                        address += 1; 
-                    }
-                }
-              }    
-            }
-          // break if at the end of the data section
-          break; 
-        }
-        // Check for labels
-        else if (trimmedLine.find(":") != std::string::npos) {
-            size_t colonPos = trimmedLine.find(":");
-            std::string label = trimmedLine.substr(0, colonPos);
-            labelAddresses[padName(label)] = address; 
-
-             //std::cout << "Label: " << padName(label) << " Address: " << labelAddresses[padName(label)] << std::endl;
-             if (std::getline(file, line)) {
-                instructions.push_back(line); // Store instruction
-                address += 1; 
-            }
-        }
-        // Regular instruction
-        else {
-            instructions.push_back(trimmedLine);
-            address += 1; 
-          }
+    size_t size = info.st_size;
+    const uint8_t *file = nullptr;
+    if (size >= OBJ_HEADER_SIZE) {
+        void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        file = mapped == MAP_FAILED ? nullptr : static_cast<const uint8_t*>(mapped);
     }
+    close(fd);
 
-    // Substitute addresses in instructions
-    int memAddress = initialAddress;
-    for (auto instruction : instructions) {
-        for (const auto& [label, addr] : labelAddresses) {
-            size_t pos = instruction.find(label);
-            if (pos != std::string::npos) {
-                // Substitute label with address
-                instruction.replace(pos, label.length(), std::bitset<16>(addr).to_string());
-            }
-        }
-        for (const auto& [varName, addr] : variableAddresses) {
-            size_t pos = instruction.find(varName);
-            if (pos != std::string::npos) {
-                // Substitute variable with address
-                instruction.replace(pos, varName.length(), std::bitset<16>(addr).to_string());
+    if (file == nullptr || get32(file) != OBJ_MAGIC || get16(file + 4) != OBJ_VERSION) {
+        std::cerr << "Invalid object file: " << inputFile << std::endl;
+        exit(1);
+    }
+
+    objHeader header;
+    header.headerSize = get16(file + 6);
+    header.textWords = get32(file + 8);
+    header.dataWords = get32(file + 12);
+    header.symbolCount = get32(file + 16);
+    header.relocCount = get32(file + 20);
+    header.stringSize = get32(file + 24);
+
+    const uint8_t *text = file + header.headerSize;
+    const uint8_t *data = text + 4 * (size_t)header.textWords;
+    const uint8_t *symbols = data + 4 * (size_t)header.dataWords;
+    const uint8_t *relocs = symbols + OBJ_SYMBOL_SIZE * (size_t)header.symbolCount;
+    const char *strings = reinterpret_cast<const char*>(relocs + OBJ_RELOC_SIZE * (size_t)header.relocCount);
+
+    if (header.headerSize < OBJ_HEADER_SIZE || header.headerSize % 4 != 0
+        || reinterpret_cast<const uint8_t*>(strings) + header.stringSize > file + size) {
+        std::cerr << "Truncated object file: " << inputFile << std::endl;
+        exit(1);
+    }
+
+    uint32_t textAddress = initialAddress;
+    uint32_t dataAddress = textAddress + header.textWords;
+    // a pilha cresce para baixo a partir de stackTop, logo após os dados
+    uint32_t stackTop = dataAddress + header.dataWords + PROGRAM_STACK_WORDS;
+    int address = stackTop;
+    if (address >= MEMORY_SIZE) {
+        std::cerr << "Memory overflow while loading " << inputFile << std::endl;
+        exit(1);
+    }
+
+    copySegment(ram, textAddress, text, header.textWords);
+    copySegment(ram, dataAddress, data, header.dataWords);
+
+    // Endereço absoluto de cada símbolo
+    std::vector<int64_t> symbolAddresses(header.symbolCount, -1);
+    for (uint32_t i = 0; i < header.symbolCount; i++) {
+        const uint8_t *symbol = symbols + OBJ_SYMBOL_SIZE * i;
+        uint32_t value = get32(symbol + 4);
+        uint8_t section = symbol[8];
+        if (section == SEC_TEXT) {
+            symbolAddresses[i] = textAddress + value;
+            if (get32(symbol) < header.stringSize) {
+                layout.labelAddresses.emplace(textAddress + value, strings + get32(symbol));
             }
+        } else if (section == SEC_DATA) {
+            symbolAddresses[i] = dataAddress + value;
         }
-        
-        size_t pos = instruction.find("#");
-        if (pos != std::string::npos) {
-            std::cerr << "Can't resolve symbol at instruction: " << instruction << std::endl; 
+    }
+
+    for (uint32_t i = 0; i < header.relocCount; i++) {
+        const uint8_t *reloc = relocs + OBJ_RELOC_SIZE * i;
+        uint32_t offset = get32(reloc);
+        uint32_t symbol = get32(reloc + 4);
+
+        if (offset >= header.textWords || symbol >= header.symbolCount || symbolAddresses[symbol] < 0) {
+            const char *name = symbol < header.symbolCount ? strings + get32(symbols + OBJ_SYMBOL_SIZE * symbol) : "?";
+            std::cerr << "Can't resolve symbol \"" << name << "\" at instruction " << offset << std::endl;
+            continue;
         }
 
-        // Convert instruction string to binary and store in memory
-        try {
-            ram.WriteMem(memAddress, std::stoul(instruction, nullptr, 2));
-        } catch (const std::exception& e) {
-            std::cerr << "Conversion error at: " << instruction << std::endl;
+        // o imediato não comporta o endereço: carregar assim rodaria com o endereço errado
+        if (symbolAddresses[symbol] > 0xFFFF) {
+            std::cerr << "Symbol \"" << strings + get32(symbols + OBJ_SYMBOL_SIZE * symbol)
+                      << "\" of " << inputFile << " is loaded at " << symbolAddresses[symbol]
+                      << ", beyond the 16-bit absolute range of instruction " << offset << std::endl;
+            exit(1);
         }
-        memAddress++;
+
+        uint32_t word = ram.ReadMem(textAddress + offset);
+        word = (word & 0xFFFF0000) | (symbolAddresses[symbol] & 0xFFFF);
+        ram.WriteMem(textAddress + offset, word);
     }
-    
+
+    munmap(const_cast<uint8_t*>(file), size);
+
+    layout.data = dataAddress;
+    layout.stackTop = stackTop;
+
     return address + 1;
 
 }
@@ -2,8 +2,20 @@
 #define LOADER_H
 
 #include"../memory/MAINMEMORY.h"
+#include <cstdint>
+#include <map>
 #include <string>
 
-int loadProgram(std::string inputFile, MainMemory & ram, int initialAddress);
+#define PROGRAM_STACK_WORDS 1024
+
+// Segmentos de um programa carregado: texto | dados | pilha.
+struct programLayout {
+    uint32_t data;          // início dos dados, valor inicial de $gp
+    uint32_t stackTop;      // uma palavra após o fim da pilha, valor inicial de $sp e $fp
+    std::map<uint32_t, std::string> labelAddresses;     // endereço absoluto -> label do texto
+};
+
+// Carrega o programa em initialAddress e retorna o endereço livre seguinte.
+int loadProgram(std::string inputFile, MainMemory & ram, int initialAddress, programLayout &layout);
 
 #endif
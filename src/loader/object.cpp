@@ -0,0 +1,74 @@
+#include <fstream>
+#include <iostream>
+
+#include"./object.h"
+
+static void put16(std::vector<uint8_t> &out, uint16_t value) {
+    out.push_back(value & 0xFF);
+    out.push_back(value >> 8);
+}
+
+static void put32(std::vector<uint8_t> &out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back((value >> shift) & 0xFF);
+    }
+}
+
+uint32_t objectFile::AddString(const std::string &name) {
+    uint32_t offset = strings.size();
+    strings += name;
+    strings += '\0';
+    return offset;
+}
+
+uint32_t objectFile::AddSymbol(const std::string &name, uint32_t value, uint8_t section) {
+    symbols.push_back(objSymbol{AddString(name), value, section});
+    return symbols.size() - 1;
+}
+
+const char* objectFile::SymbolName(const objSymbol &symbol) const {
+    return strings.c_str() + symbol.name;
+}
+
+bool writeObject(const std::string &path, const objectFile &object) {
+    std::vector<uint8_t> out;
+    out.reserve(OBJ_HEADER_SIZE + 4 * (object.text.size() + object.data.size())
+                + OBJ_SYMBOL_SIZE * object.symbols.size() + OBJ_RELOC_SIZE * object.relocs.size()
+                + object.strings.size());
+
+    put32(out, OBJ_MAGIC);
+    put16(out, OBJ_VERSION);
+    put16(out, OBJ_HEADER_SIZE);
+    put32(out, object.text.size());
+    put32(out, object.data.size());
+    put32(out, object.symbols.size());
+    put32(out, object.relocs.size());
+    put32(out, object.strings.size());
+    put32(out, object.entry);
+
+    for (uint32_t word : object.text) {
+        put32(out, word);
+    }
+    for (uint32_t word : object.data) {
+        put32(out, word);
+    }
+    for (const objSymbol &symbol : object.symbols) {
+        put32(out, symbol.name);
+        put32(out, symbol.value);
+        put32(out, symbol.section);
+    }
+    for (const objReloc &reloc : object.relocs) {
+        put32(out, reloc.offset);
+        put32(out, reloc.symbol);
+        put32(out, reloc.type);
+    }
+    out.insert(out.end(), object.strings.begin(), object.strings.end());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error opening file: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(out.data()), out.size());
+    return file.good();
+}
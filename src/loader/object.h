@@ -0,0 +1,74 @@
+#ifndef OBJECT_H
+#define OBJECT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Formato objeto gerado pelo assembler em programs/*.bin. Todos os campos
+// são palavras little-endian, na ordem:
+//
+//   cabeçalho | texto | dados | símbolos | relocações | strings
+//
+// Endereços de símbolos são relativos ao início da sua seção. Desvios são
+// relativos ao pc e variáveis são acessadas como offset($gp), então o texto
+// não depende de onde o programa é carregado; o loader só corrige as poucas
+// relocações absolutas (label usado como dado).
+
+#define OBJ_MAGIC       0x4A424F56      // "VOBJ"
+#define OBJ_VERSION     2
+
+#define OBJ_HEADER_SIZE 32
+#define OBJ_SYMBOL_SIZE 12
+#define OBJ_RELOC_SIZE  12
+
+enum objSection : uint8_t {
+    SEC_UNDEF,
+    SEC_TEXT,
+    SEC_DATA
+};
+
+enum objRelocType : uint8_t {
+    REL_ABS16           // imediato de 16 bits recebe o endereço absoluto
+};
+
+struct objHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t textWords;
+    uint32_t dataWords;
+    uint32_t symbolCount;
+    uint32_t relocCount;
+    uint32_t stringSize;
+    uint32_t entry;         // palavra do texto onde o programa começa
+};
+
+struct objSymbol {
+    uint32_t name;          // deslocamento na tabela de strings
+    uint32_t value;         // palavra dentro da seção
+    uint8_t section;
+};
+
+struct objReloc {
+    uint32_t offset;        // palavra do texto a corrigir
+    uint32_t symbol;        // índice na tabela de símbolos
+    uint8_t type;
+};
+
+struct objectFile {
+    std::vector<uint32_t> text;
+    std::vector<uint32_t> data;
+    std::vector<objSymbol> symbols;
+    std::vector<objReloc> relocs;
+    std::string strings;
+    uint32_t entry = 0;
+
+    uint32_t AddString(const std::string &name);
+    uint32_t AddSymbol(const std::string &name, uint32_t value, uint8_t section);
+    const char* SymbolName(const objSymbol &symbol) const;
+};
+
+bool writeObject(const std::string &path, const objectFile &object);
+
+#endif
@@ -4,11 +4,14 @@
 #include "./loader/loader.h"
 #include "./assembler/assembler.h"
 #include "./PCB.h"
+#include "./sim/LOCKSTEP.h"
+#include "./sim/SCHEDULER.h"
 
 #include <unistd.h>
 #include <cstdlib>
 #include <pthread.h>
 #include <filesystem>
+#include <cstring>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -18,6 +21,8 @@ using namespace std;
 #define NUM_CORES 2
 #define QUANTUM 10 
 // 1 clock = 1 quantum
+#define IO_QUEUE_SIZE 64
+#define DISK_SIZE 4096
 
 string getFileName(char* file) {
     string filePath(file);
@@ -30,99 +35,265 @@ string getFileName(char* file) {
     return fileName;
 }
 
-void* coreManage(void* arg) {
-    scheduleInfo* info = static_cast<scheduleInfo*>(arg);
-
-    while (!info->shutdown) {
-        PCB* currentProcess = nullptr;
-
-        {
-            lock_guard<mutex> lock(*info->queueLock);
+// Chamadas e retornos de todos os processos e acertos da pilha de retorno do Fetch.
+void printCallStats(const vector<unique_ptr<PCB>> &processes, ostream &out) {
+    uint64_t calls = 0, returns = 0, mispredicted = 0;
+    for (const auto &pcb : processes) {
+        calls += pcb->calls;
+        returns += pcb->returns;
+        mispredicted += pcb->returnsMispredicted;
+    }
+    out << "Return stack: " << calls << " calls, " << returns << " returns, "
+        << returns - mispredicted << " predicted, " << mispredicted << " mispredicted" << endl;
+}
 
-            
-            // Find a ready process
-            for (auto& pcb : *info->processes) {
-                if (pcb->state == State::Ready && pcb->state != State::Blocked) {
-                    currentProcess = pcb.get();
-                    currentProcess->state = State::Executing;
-                    break;
-                }
-            }
-        }
+// Instruções vetoriais de todos os processos e o kernel do host em uso.
+void printVectorStats(const vector<unique_ptr<PCB>> &processes, ostream &out) {
+    uint64_t instructions = 0, elements = 0;
+    for (const auto &pcb : processes) {
+        instructions += pcb->vectorInstructions;
+        elements += pcb->vectorElements;
+    }
+    out << "Vector unit (" << VectorBackend() << "): " << instructions << " instructions, "
+        << elements << " elements" << endl;
+}
 
-        if (currentProcess) {
-            Core(*info->ram, *currentProcess, info->ioRequests,info->printLock);
+// Contadores do pipeline e pilha de CPI de cada núcleo e de cada processo.
+void printPipelineStats(const scheduleInfo &info, ostream &out) {
+    for (size_t i = 0; i < info.pipelineCounters.size(); i++) {
+        info.pipelineCounters[i].Print(out, "core " + to_string(i));
+    }
+    for (const auto &pcb : *info.processes) {
+        pcb->pipeline.Print(out, "process " + to_string(pcb->id));
+    }
+}
 
-            lock_guard<mutex> lock(*info->queueLock);
-            if (currentProcess->state == State::Executing) {
-                currentProcess->state = State::Ready;
-            }
-        }
+// Vazão da máquina simulada e do simulador e, por processo, o tempo até
+// terminar (desde a chegada) e o tempo pronto esperando um núcleo.
+void printSchedulerStats(const scheduleInfo &info, uint64_t cycles, chrono::milliseconds wallTime, ostream &out) {
+    uint64_t instructions = 0;
+    for (const PIPELINE_COUNTERS &counters : info.pipelineCounters) {
+        instructions += counters.instructions;
     }
+    const double seconds = max<double>(wallTime.count(), 1) / 1000;
+    out << "Throughput: " << instructions << " instructions on " << info.pipelineCounters.size() << " cores, IPC "
+        << fixed << setprecision(3) << (cycles ? (double)instructions / cycles : 0.0) << ", "
+        << instructions / seconds / 1e6 << " simulated MIPS, " << setprecision(0) << cycles / seconds
+        << " simulated cycles/s" << defaultfloat << endl;
+
+    uint64_t dispatches = 0, turnaround = 0, maxTurnaround = 0, wait = 0, maxWait = 0;
+    for (const auto &pcb : *info.processes) {
+        dispatches += pcb->dispatches;
+        turnaround += pcb->finishTime - pcb->arrivalTime;
+        maxTurnaround = max(maxTurnaround, pcb->finishTime - pcb->arrivalTime);
+        wait += pcb->readyWait;
+        maxWait = max(maxWait, pcb->readyWait);
+    }
+    const size_t count = max<size_t>(info.processes->size(), 1);
+    out << "Scheduler: " << info.processes->size() << " processes, " << dispatches << " dispatches, turnaround avg "
+        << turnaround / count << " max " << maxTurnaround << " cycles, ready wait avg " << wait / count
+        << " max " << maxWait << " cycles" << endl;
+}
 
-    return nullptr;
+// Travas instrumentadas por --lock-stats: a fila de processos e os caminhos de E/S
+// (eventos do relógio e interrupções de cada núcleo).
+vector<PROFILED_MUTEX*> profiledLocks(scheduleInfo &info) {
+    vector<PROFILED_MUTEX*> locks{info.queueLock, &info.clock->eventLock};
+    for (auto& irq : info.interrupts) {
+        locks.push_back(&irq->lock);
+    }
+    return locks;
 }
 
-void* scheduler(void* arg) {
-    scheduleInfo* info = static_cast<scheduleInfo*>(arg);
+// Pontos quentes de cada processo e, com --profile-out, as pilhas para flamegraph.
+void printProfile(const PROFILER *profiler, const string &path, ostream &out) {
+    if (profiler == nullptr) {
+        return;
+    }
+    profiler->PrintHotSpots(out, 10);
+    if (!path.empty() && !profiler->WriteFolded(path)) {
+        cerr << "Error writing profile to " << path << endl;
+    }
+}
 
-    while (!info->shutdown) {
-        lock_guard<mutex> lock(*info->queueLock);
+// O que o fim da execução imprime além do que está no scheduleInfo.
+struct runReport {
+    chrono::milliseconds wallTime;
+    bool deterministic;
+    uint64_t windows;           // só no modo determinístico
+    uint64_t window;
+    bool stats;
+    bool lockStats;
+    string profileOut;
+};
+
+// Fecha o trace e o segmento ao vivo e imprime os relatórios pedidos, depois
+// de qualquer um dos dois modos de execução.
+void printReports(scheduleInfo &info, const runReport &run) {
+    if (info.trace) {
+        info.trace->Close(cerr);
+    }
+    if (info.live) {
+        info.live->Close(info);
+    }
 
-        bool allDone = true;
-        
-        for (const auto& pcb : *info->processes) {
-            if (pcb->state != State::Finished) {
-                allDone = false;
-                break;
-            }
+    if (run.stats) {
+        cerr << "Simulated time: " << info.clock->FinalTime() << " cycles, "
+             << info.clock->eventsFired.load() << " events, ";
+        if (run.deterministic) {
+            cerr << run.windows << " windows of " << run.window << " cycles, ";
         }
-
-        if(!info->ioRequests->empty()){
-            allDone = false;
+        cerr << "wall time " << run.wallTime.count() << " ms" << endl;
+        info.io->PrintStats(cerr);
+        for (auto& irq : info.interrupts) {
+            irq->PrintStats(cerr);
         }
-                
-        if (allDone) {
-            //cout << "Shutdown" << endl;
-            info->shutdown = true;
+        printCallStats(*info.processes, cerr);
+        printVectorStats(*info.processes, cerr);
+        for (size_t i = 0; i < info.executionUnits.size(); i++) {
+            info.executionUnits[i].PrintStats(cerr, i);
         }
+        printPipelineStats(info, cerr);
+        printSchedulerStats(info, info.clock->FinalTime(), run.wallTime, cerr);
+    }
+    printProfile(info.profiler, run.profileOut, cerr);
+    if (info.host) {
+        info.host->Print(cerr);
+    }
+    if (run.lockStats) {
+        printLockStats(profiledLocks(info), run.wallTime, cerr);
     }
-
-    return nullptr;
 }
 
+int main(int argc, char* argv[]) {
+    // Separate options from input files
+    bool stats = false;
+    assemblyOptions assembler;
+    bool deterministic = false;
+    uint64_t window = LOCKSTEP_WINDOW;
+    uint64_t seed = 0;
+    uint64_t arrivalInterval = 0;
+    size_t ioQueueSize = IO_QUEUE_SIZE;
+    bool outOfOrder = false;
+    unsigned issueWidth = 1;
+    unsigned contexts = 1;
+    string fetchPolicy = "rr";
+    uint64_t profileInterval = 0;
+    string profileOut;
+    string tracePath;
+    bool perf = false;
+    bool perfStages = false;
+    string liveName;
+    bool lockStats = false;
+    int numCores = NUM_CORES;
+    vector<string> deviceOptions;
+    vector<string> latencyOptions;
+    vector<char*> inputs;
+    for (int i = 0; i < argc; i++) {
+        if (i > 0 && strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (i > 0 && strcmp(argv[i], "--no-asm-cache") == 0) {
+            assembler.useCache = false;
+        } else if (i > 0 && strcmp(argv[i], "-O") == 0) {
+            assembler.optimize = true;
+        } else if (i > 0 && strcmp(argv[i], "--deterministic") == 0) {
+            deterministic = true;
+        } else if (i > 0 && strncmp(argv[i], "--deterministic=", 16) == 0) {
+            deterministic = true;
+            window = stoull(argv[i] + 16);
+        } else if (i > 0 && strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = stoull(argv[i] + 7);
+        } else if (i > 0 && strncmp(argv[i], "--arrival=", 10) == 0) {
+            arrivalInterval = stoull(argv[i] + 10);
+        } else if (i > 0 && strncmp(argv[i], "--io-queue=", 11) == 0) {
+            ioQueueSize = stoul(argv[i] + 11);
+        } else if (i > 0 && strcmp(argv[i], "--ooo") == 0) {
+            outOfOrder = true;
+        } else if (i > 0 && strncmp(argv[i], "--issue-width=", 14) == 0) {
+            issueWidth = stoul(argv[i] + 14);
+        } else if (i > 0 && strncmp(argv[i], "--smt=", 6) == 0) {
+            contexts = stoul(argv[i] + 6);
+        } else if (i > 0 && strncmp(argv[i], "--fetch-policy=", 15) == 0) {
+            fetchPolicy = argv[i] + 15;
+        } else if (i > 0 && strncmp(argv[i], "--profile=", 10) == 0) {
+            profileInterval = stoull(argv[i] + 10);
+        } else if (i > 0 && strncmp(argv[i], "--profile-out=", 14) == 0) {
+            profileOut = argv[i] + 14;
+        } else if (i > 0 && strcmp(argv[i], "--perf") == 0) {
+            perf = true;
+        } else if (i > 0 && strcmp(argv[i], "--perf=stages") == 0) {
+            perf = true;
+            perfStages = true;
+        } else if (i > 0 && strcmp(argv[i], "--lock-stats") == 0) {
+            lockStats = true;
+        } else if (i > 0 && strcmp(argv[i], "--live") == 0) {
+            liveName = LIVE_DEFAULT_NAME;
+        } else if (i > 0 && strncmp(argv[i], "--live=", 7) == 0) {
+            liveName = argv[i] + 7;
+        } else if (i > 0 && strncmp(argv[i], "--cores=", 8) == 0) {
+            numCores = stoi(argv[i] + 8);
+        } else if (i > 0 && strncmp(argv[i], "--trace=", 8) == 0) {
+            tracePath = argv[i] + 8;
+        } else if (i > 0 && strncmp(argv[i], "--latency=", 10) == 0) {
+            latencyOptions.push_back(argv[i] + 10);
+        } else if (i > 0 && (strncmp(argv[i], "--io-time=", 10) == 0 || strncmp(argv[i], "--io-workers=", 13) == 0)) {
+            deviceOptions.push_back(argv[i]);
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+    argc = inputs.size();
+    argv = inputs.data();
 
-void * resourceManager(void * arg){
-    scheduleInfo* info = static_cast<scheduleInfo*>(arg);
-    
-   
-    while (!info->shutdown) {
-
-        if(!info->ioRequests->empty()){
-            
-            auto req = move(info->ioRequests->front());
-            info->printLock = true;
+    if (argc < 2) {
+        cerr << "Usage: " << argv[0] << " [--stats] [-O] [--no-asm-cache] [--deterministic[=WINDOW]] [--cores=N] [--seed=N] [--arrival=CYCLES] [--io-queue=N] [--io-time=<device>:<us>] "
+             << "[--io-workers=<device>:<n>] [--ooo] [--issue-width=1|2|4] [--smt=N] [--fetch-policy=rr|icount] [--latency=<op>:<cycles>] [--profile=CYCLES] [--profile-out=FILE] [--trace=FILE] [--perf[=stages]] [--live[=NAME]] [--lock-stats] <input_files>" << endl;
+        return 1;
+    }
 
-            info->ioRequests->erase(info->ioRequests->begin());
+    if (numCores < 1 || numCores > 255) {
+        cerr << "Invalid core count: " << numCores << endl;
+        return 1;
+    }
 
-            // Simulate a 0.1 ms delay
-            usleep(100000);
+    SECONDARY_MEMORY disk(DISK_SIZE);
+    IO_SUBSYSTEM io(disk, ioQueueSize);
 
-            cout << "Program " << req->process->id << ": " << req->msg << std::endl;          
-             
-            req->process->state = State::Ready;
-            info->printLock = false;
+    // Device options have the form --io-time=disk:5000 / --io-workers=disk:4
+    for (const string &option : deviceOptions) {
+        size_t eq = option.find('=');
+        size_t colon = option.find(':');
+        DEVICE* device = colon == string::npos ? nullptr : io.FindDevice(option.substr(eq + 1, colon - eq - 1));
+        if (device == nullptr) {
+            cerr << "Invalid device option: " << option << endl;
+            return 1;
+        }
+        unsigned value = stoul(option.substr(colon + 1));
+        if (option.compare(0, 10, "--io-time=") == 0) {
+            device->serviceTime = value;
+        } else {
+            device->parallelism = max(1u, value);
         }
     }
 
-    return nullptr;
-}
-
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        cerr << "Usage: " << argv[0] << " <input_files>" << endl;
+    // Latency options have the form --latency=mult:4 and apply to every core
+    EXECUTION_UNITS units;
+    units.outOfOrder = outOfOrder;
+    if (!units.SetIssueWidth(issueWidth)) {
+        cerr << "Invalid issue width: " << issueWidth << endl;
         return 1;
     }
+    if (!units.SetContexts(contexts, fetchPolicy)) {
+        cerr << "Invalid SMT option: --smt=" << contexts << " --fetch-policy=" << fetchPolicy << endl;
+        return 1;
+    }
+    for (const string &option : latencyOptions) {
+        size_t colon = option.find(':');
+        if (colon == string::npos || !units.SetLatency(option.substr(0, colon), stoul(option.substr(colon + 1)))) {
+            cerr << "Invalid latency option: --latency=" << option << endl;
+            return 1;
+        }
+    }
 
     // Trim filepaths to get file names
     vector<string> files;
@@ -131,23 +302,77 @@ int main(int argc, char* argv[]) {
     }
 
     // Compile prograns
-    assembleFiles(argc, files, argv);
+    assembler.report = stats;
+    int cacheHits = assembleFiles(argc, files, argv, assembler);
+    if (stats) {
+        cerr << "Assembler cache: " << cacheHits << " hits, " << argc - 1 - cacheHits << " misses" << endl;
+    }
 
     MainMemory ram = MainMemory(2048, 2048);
     int initProgram[argc];
+    vector<programLayout> layout(argc);
     initProgram[0] = 0;
     
     for (int i = 1; i < argc; i++) {
-        initProgram[i] = loadProgram(files[i], ram, initProgram[i - 1]);
+        initProgram[i] = loadProgram(files[i], ram, initProgram[i - 1], layout[i]);
     }
 
     auto scheduleInfo = make_unique<struct scheduleInfo>();
     scheduleInfo->ram = &ram;
     scheduleInfo->processes = new vector<unique_ptr<PCB>>();
-    scheduleInfo->ioRequests = new vector<unique_ptr<ioRequest>>();
-    scheduleInfo->queueLock = new mutex();
+    scheduleInfo->io = &io;
+    scheduleInfo->queueLock = new PROFILED_MUTEX("queueLock");
     scheduleInfo->shutdown = false;
-    scheduleInfo->printLock = false;
+
+    SIM_CLOCK clock(numCores);
+    scheduleInfo->clock = &clock;
+    for (int i = 0; i < numCores; i++) {
+        scheduleInfo->interrupts.push_back(make_unique<INTERRUPT_CONTROLLER>(i));
+    }
+    scheduleInfo->returnStacks.resize(numCores * contexts);
+    scheduleInfo->executionUnits.assign(numCores, units);
+    scheduleInfo->pipelineCounters.resize(numCores);
+    if (lockStats) {
+        for (PROFILED_MUTEX* lock : profiledLocks(*scheduleInfo)) {
+            lock->profiling = true;
+        }
+    }
+    unique_ptr<PROFILER> profiler;
+    if (profileInterval > 0) {
+        profiler = make_unique<PROFILER>(numCores, profileInterval);
+        for (int i = 1; i < argc; i++) {
+            profiler->AddProgram(i, files[i], layout[i].labelAddresses);
+        }
+        scheduleInfo->profiler = profiler.get();
+    }
+    unique_ptr<TRACE_RECORDER> trace;
+    if (!tracePath.empty()) {
+        map<uint8_t, string> opcodes;
+        for (const auto& [name, code] : Control_Unit().instructionMap) {
+            opcodes[stoul(code, nullptr, 2)] = name;
+        }
+        trace = make_unique<TRACE_RECORDER>(numCores);
+        if (!trace->Open(tracePath, opcodes)) {
+            cerr << "Error opening trace file " << tracePath << endl;
+            return 1;
+        }
+        scheduleInfo->trace = trace.get();
+    }
+    unique_ptr<HOST_COUNTERS> host;
+    if (perf) {
+        host = make_unique<HOST_COUNTERS>(numCores, perfStages);
+        scheduleInfo->host = host.get();
+    }
+    unique_ptr<LIVE_STATS> live;
+    if (!liveName.empty()) {
+        live = make_unique<LIVE_STATS>(numCores);
+        if (!live->Open(liveName)) {
+            cerr << "Error creating shared memory segment " << liveName << ": " << live->error << endl;
+            return 1;
+        }
+        scheduleInfo->live = live.get();
+    }
+    io.Start(scheduleInfo.get(), &clock);
 
     for (int i = 1; i < argc; i++) {
         auto pcb = make_unique<PCB>();
@@ -157,31 +382,68 @@ int main(int argc, char* argv[]) {
         pcb->id = i;
         pcb->state = State::Ready;
         pcb->regBank.pc.value = initProgram[i - 1];
+        pcb->regBank.sr.write(SR_DEFAULT);
+        pcb->regBank.gp.write(layout[i].data);
+        pcb->regBank.sp.write(layout[i].stackTop);
+        pcb->regBank.fp.write(layout[i].stackTop);
+
+        // Processes arrive every arrivalInterval virtual cycles
+        uint64_t arrival = (i - 1) * arrivalInterval;
+        pcb->arrivalTime = arrival;
+        if (arrival > 0) {
+            PCB* process = pcb.get();
+            PROFILED_MUTEX* queueLock = scheduleInfo->queueLock;
+            process->state = State::New;
+            clock.Schedule(arrival, [process, queueLock, arrival]() {
+                profiledGuard lock(*queueLock);
+                process->readyTime = arrival;
+                process->state = State::Ready;
+            });
+        }
         scheduleInfo->processes->push_back(move(pcb));
     }
 
-    pthread_t threads[NUM_CORES + 2];
+    auto wallStart = chrono::steady_clock::now();
+
+    uint64_t windows = 0;
+    if (deterministic) {
+        windows = runLockstep(scheduleInfo.get(), numCores, window, seed);
+    } else {
+        vector<pthread_t> threads(numCores + 2);
+        vector<coreArgs> cores(numCores);
 
-    for (int i = 0; i < NUM_CORES; ++i) {
-        if (pthread_create(&threads[i], nullptr, coreManage, scheduleInfo.get()) != 0) {
-            cerr << "Error creating core thread " << i << endl;
+        for (int i = 0; i < numCores; ++i) {
+            cores[i] = coreArgs{scheduleInfo.get(), i};
+            if (pthread_create(&threads[i], nullptr, coreManage, &cores[i]) != 0) {
+                cerr << "Error creating core thread " << i << endl;
+                return 1;
+            }
+        }
+
+        if (pthread_create(&threads[numCores], nullptr, scheduler, scheduleInfo.get()) != 0) {
+            cerr << "Error creating scheduler thread" << endl;
+            return 1;
+        }
+        if (pthread_create(&threads[numCores + 1], nullptr, clockManage, scheduleInfo.get()) != 0) {
+            cerr << "Error creating clock thread" << endl;
             return 1;
         }
-    }
 
-    if (pthread_create(&threads[NUM_CORES], nullptr, scheduler, scheduleInfo.get()) != 0) {
-        cerr << "Error creating scheduler thread" << endl;
-        return 1;
-    }
-    if (pthread_create(&threads[NUM_CORES +1], nullptr, resourceManager, scheduleInfo.get()) != 0) {
-        cerr << "Error creating I/O manage thread" << endl;
-        return 1;
+        // Join threads
+        for (int i = 0; i < numCores + 2; i++) {
+            pthread_join(threads[i], nullptr);
+        }
     }
 
-    // Join threads
-    for (int i = 0; i < NUM_CORES + 2; i++) {
-        pthread_join(threads[i], nullptr);
-    }
+    runReport report;
+    report.wallTime = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - wallStart);
+    report.deterministic = deterministic;
+    report.windows = windows;
+    report.window = window;
+    report.stats = stats;
+    report.lockStats = lockStats;
+    report.profileOut = profileOut;
+    printReports(*scheduleInfo, report);
 
     return 0;
 }
@@ -1,5 +1,7 @@
 #include "MAINMEMORY.h"
 
+#include <algorithm>
+
 
 bool MainMemory::EmptyLine(int i) const
 {
@@ -47,6 +49,25 @@ void MainMemory::WriteMem(const uint32_t address, const uint32_t data) {
     words[iTarget][jTarget].write(data);
 }
 
+// Copia count palavras a partir de address, linha por linha da matriz.
+void MainMemory::WriteBlock(const uint32_t address, const uint32_t *data, size_t count) {
+    if (address + count > (size_t)NumOfi * NumOfj) {
+        printf("Endereço inválido!\n");
+        return;
+    }
+    size_t done = 0;
+    while (done < count) {
+        int iTarget = (address + done) / NumOfj;
+        int jTarget = (address + done) % NumOfj;
+        size_t run = min<size_t>(count - done, NumOfj - jTarget);
+        MemoryCell *row = words[iTarget] + jTarget;
+        for (size_t k = 0; k < run; k++) {
+            row[k].write(data[done + k]);
+        }
+        done += run;
+    }
+}
+
 const uint32_t MainMemory::ReadMem(const uint32_t address) {
     if (address >= NumOfi * NumOfj) {
         printf("Endereço inválido!\n");
@@ -57,3 +78,16 @@ const uint32_t MainMemory::ReadMem(const uint32_t address) {
     
     return words[iTarget][jTarget].read();
 }
+
+// Palavras contíguas a partir de address até o fim da linha da matriz; run
+// recebe quantas são. Retorna nullptr se o endereço for inválido.
+uint32_t* MainMemory::Words(const uint32_t address, size_t &run) {
+    if (address >= (size_t)NumOfi * NumOfj) {
+        run = 0;
+        return nullptr;
+    }
+    int iTarget = address / NumOfj;
+    int jTarget = address % NumOfj;
+    run = NumOfj - jTarget;
+    return reinterpret_cast<uint32_t*>(words[iTarget] + jTarget);
+}
@@ -36,7 +36,9 @@ struct MainMemory{
 	void EraseData(int iTarget, int jTarget);
 	bool EmptyLine(int i) const;
 	void WriteMem(const uint32_t address, const uint32_t data);
+	void WriteBlock(const uint32_t address, const uint32_t *data, size_t count);
 	const uint32_t ReadMem(const uint32_t address);
+	uint32_t* Words(const uint32_t address, size_t &run);
 
 //	void ShowBit(int NumOfj, int NumOfi);
 //	void WriteBit(REGISTER value, int iTarget, int jTarget);
@@ -8,7 +8,6 @@
 struct MemoryCell
 {
     uint32_t value;
-    MemoryCell *next;
     MemoryCell() : value(0x0000) {}
 
     void write(const uint32_t new_value);
@@ -17,4 +16,8 @@ struct MemoryCell
     [[nodiscard]] uint32_t reverse_read() const;
 
 };
+
+// Uma linha da MainMemory é um vetor contíguo de palavras, lido direto pelos
+// kernels vetoriais (MainMemory::Words).
+static_assert(sizeof(MemoryCell) == sizeof(uint32_t), "MemoryCell deve ter uma palavra");
 #endif
@@ -0,0 +1,208 @@
+#include "HOST_COUNTERS.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const char* eventNames[NUM_HOST_EVENTS] = {"cycles", "instructions", "cache misses", "branch misses", "task-clock ns"};
+static const char* scopeNames[NUM_HOST_SCOPES] = {"Core()", "fetch", "decode", "schedule", "execute", "memory", "interrupt"};
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} eventConfigs[NUM_HOST_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+};
+
+HOST_COUNTERS::HOST_COUNTERS(int numCores, bool stages) : stages(stages), cores(numCores) {}
+
+HOST_COUNTERS::~HOST_COUNTERS(){
+    for(hostCore &state : cores){
+        for(int event = 0; state.opened && event < NUM_HOST_EVENTS; event++){
+            if(state.fds[event] >= 0){
+                close(state.fds[event]);
+            }
+        }
+    }
+}
+
+// Um grupo por thread (pid 0, qualquer CPU), só em modo usuário; o primeiro
+// evento que abrir lidera o grupo, então um read devolve todos de uma vez.
+bool HOST_COUNTERS::Open(hostCore &state){
+    state.opened = true;
+    int next = 0;
+    for(int event = 0; event < NUM_HOST_EVENTS; event++){
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = eventConfigs[event].type;
+        attr.config = eventConfigs[event].config;
+        attr.disabled = state.leader < 0;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        state.fds[event] = syscall(SYS_perf_event_open, &attr, 0, -1, state.leader, 0);
+        state.slot[event] = -1;
+        if(state.fds[event] < 0){
+            if(state.error.empty()){
+                state.error = string(eventNames[event]) + ": " + strerror(errno);
+            }
+            continue;
+        }
+        if(state.leader < 0){
+            state.leader = state.fds[event];
+        }
+        state.slot[event] = next++;
+    }
+    if(state.leader < 0){
+        return false;
+    }
+    ioctl(state.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+bool HOST_COUNTERS::Read(hostCore &state, uint64_t values[NUM_HOST_EVENTS]){
+    if(!state.opened && !Open(state)){
+        return false;
+    }
+    if(state.leader < 0){
+        return false;
+    }
+    uint64_t group[1 + NUM_HOST_EVENTS];
+    if(read(state.leader, group, sizeof(group)) <= 0){
+        return false;
+    }
+    for(int event = 0; event < NUM_HOST_EVENTS; event++){
+        values[event] = state.slot[event] >= 0 ? group[1 + state.slot[event]] : 0;
+    }
+    return true;
+}
+
+void HOST_COUNTERS::Begin(int core, hostScope scope){
+    hostCore &state = cores[core];
+    Read(state, state.start[scope]);
+}
+
+void HOST_COUNTERS::End(int core, hostScope scope){
+    hostCore &state = cores[core];
+    uint64_t now[NUM_HOST_EVENTS];
+    if(!Read(state, now)){
+        return;
+    }
+    hostTotals &totals = state.scopes[scope];
+    for(int event = 0; event < NUM_HOST_EVENTS; event++){
+        totals.events[event] += now[event] - state.start[scope][event];
+    }
+    totals.calls += 1;
+}
+
+// Fim de um Core(): soma no trecho e no modo do núcleo, com as instruções
+// simuladas que ele confirmou.
+void HOST_COUNTERS::EndCore(int core, const string &mode, uint64_t instructions){
+    hostCore &state = cores[core];
+    uint64_t before[NUM_HOST_EVENTS];
+    copy(begin(state.scopes[HOST_CORE].events), end(state.scopes[HOST_CORE].events), before);
+    const uint64_t calls = state.scopes[HOST_CORE].calls;
+    End(core, HOST_CORE);
+    if(state.scopes[HOST_CORE].calls == calls){
+        return;
+    }
+
+    hostTotals &totals = state.modes[mode];
+    for(int event = 0; event < NUM_HOST_EVENTS; event++){
+        totals.events[event] += state.scopes[HOST_CORE].events[event] - before[event];
+    }
+    totals.calls += 1;
+    totals.instructions += instructions;
+    state.scopes[HOST_CORE].instructions += instructions;
+}
+
+// Por modo, os eventos do host por instrução simulada; com --perf=stages,
+// também a parte de cada estágio.
+void HOST_COUNTERS::Print(ostream &out) const{
+    bool present[NUM_HOST_EVENTS] = {};
+    string error;
+    map<string, hostTotals> modes;
+    hostTotals scopes[NUM_HOST_SCOPES];
+    for(const hostCore &state : cores){
+        for(int event = 0; event < NUM_HOST_EVENTS; event++){
+            present[event] = present[event] || (state.opened && state.slot[event] >= 0);
+        }
+        if(error.empty()){
+            error = state.error;
+        }
+        for(const auto &[mode, totals] : state.modes){
+            hostTotals &merged = modes[mode];
+            for(int event = 0; event < NUM_HOST_EVENTS; event++){
+                merged.events[event] += totals.events[event];
+            }
+            merged.calls += totals.calls;
+            merged.instructions += totals.instructions;
+        }
+        for(int scope = 0; scope < NUM_HOST_SCOPES; scope++){
+            for(int event = 0; event < NUM_HOST_EVENTS; event++){
+                scopes[scope].events[event] += state.scopes[scope].events[event];
+            }
+            scopes[scope].calls += state.scopes[scope].calls;
+        }
+    }
+
+    out << "Host counters (perf_event, user space):";
+    for(int event = 0; event < NUM_HOST_EVENTS; event++){
+        if(!present[event]){
+            out << " " << eventNames[event] << " unavailable;";
+        }
+    }
+    if(!error.empty()){
+        out << " first error: " << error;
+    }
+    out << endl;
+    if(modes.empty()){
+        return;
+    }
+
+    out << fixed << setprecision(2);
+    uint64_t instructions = 0;
+    for(const auto &[mode, totals] : modes){
+        instructions += totals.instructions;
+        out << "[" << mode << "] " << totals.instructions << " simulated instructions in " << totals.calls << " Core() calls, per instruction:";
+        const char *separator = " ";
+        for(int event = 0; event < NUM_HOST_EVENTS; event++){
+            if(present[event]){
+                out << separator << eventNames[event] << " " << (totals.instructions ? (double)totals.events[event] / totals.instructions : 0.0);
+                separator = ", ";
+            }
+        }
+        if(present[HOST_CYCLES] && present[HOST_INSTRUCTIONS] && totals.events[HOST_CYCLES]){
+            out << ", host IPC " << (double)totals.events[HOST_INSTRUCTIONS] / totals.events[HOST_CYCLES];
+        }
+        out << endl;
+    }
+
+    if(stages){
+        out << "  per simulated instruction:" << endl << "  " << setw(12) << "scope" << setw(12) << "calls";
+        for(int event = 0; event < NUM_HOST_EVENTS; event++){
+            if(present[event]){
+                out << setw(16) << eventNames[event];
+            }
+        }
+        out << endl;
+        for(int scope = 0; scope < NUM_HOST_SCOPES; scope++){
+            out << "  " << setw(12) << scopeNames[scope] << setw(12) << scopes[scope].calls;
+            for(int event = 0; event < NUM_HOST_EVENTS; event++){
+                if(present[event]){
+                    out << setw(16) << (instructions ? (double)scopes[scope].events[event] / instructions : 0.0);
+                }
+            }
+            out << endl;
+        }
+    }
+    out << defaultfloat;
+}
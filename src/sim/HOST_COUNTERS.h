@@ -0,0 +1,92 @@
+#ifndef HOST_COUNTERS_H
+#define HOST_COUNTERS_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum hostEvent {
+    HOST_CYCLES,
+    HOST_INSTRUCTIONS,
+    HOST_CACHE_MISSES,
+    HOST_BRANCH_MISSES,
+    HOST_TASK_CLOCK,        // ns de CPU da thread; evento de software, existe mesmo sem PMU
+    NUM_HOST_EVENTS
+};
+
+// Trechos medidos: a chamada inteira de Core()/Core_SMT() e, com
+// --perf=stages, cada estágio
+enum hostScope {
+    HOST_CORE,
+    HOST_FETCH,
+    HOST_DECODE,
+    HOST_SCHEDULE,          // Describe_Operation e o timingModel
+    HOST_EXECUTE,
+    HOST_MEMORY,
+    HOST_INTERRUPT,
+    NUM_HOST_SCOPES
+};
+
+struct hostTotals {
+    uint64_t events[NUM_HOST_EVENTS] = {};
+    uint64_t calls = 0;
+    uint64_t instructions = 0;      // simuladas, só nos modos
+};
+
+// Contadores de um núcleo: abertos e lidos só pela thread que simula o núcleo.
+struct hostCore {
+    bool opened = false;
+    int leader = -1;
+    int fds[NUM_HOST_EVENTS];
+    int slot[NUM_HOST_EVENTS];      // posição no read do grupo, -1 se o evento não abriu
+    uint64_t start[NUM_HOST_SCOPES][NUM_HOST_EVENTS];
+    hostTotals scopes[NUM_HOST_SCOPES];
+    map<string, hostTotals> modes;  // Core() por modo do núcleo (EXECUTION_UNITS::ModeName)
+    string error;                   // erro do perf_event_open, se algum evento não abriu
+};
+
+// Contadores de hardware do host (perf_event_open) em volta de cada Core() e,
+// opcionalmente, de cada estágio, para medir o custo do interpretador por
+// instrução simulada. Cada núcleo abre um grupo de eventos da própria thread
+// na primeira medida; eventos que o host não tem ficam de fora do relatório.
+struct HOST_COUNTERS {
+    bool stages;
+    vector<hostCore> cores;
+
+    HOST_COUNTERS(int numCores, bool stages);
+    ~HOST_COUNTERS();
+
+    void Begin(int core, hostScope scope);
+    void End(int core, hostScope scope);
+    void EndCore(int core, const string &mode, uint64_t instructions);
+    void Print(ostream &out) const;
+
+private:
+    bool Open(hostCore &state);
+    bool Read(hostCore &state, uint64_t values[NUM_HOST_EVENTS]);
+};
+
+// Mede um estágio do construtor ao destrutor; sem --perf=stages não faz nada.
+struct hostSample {
+    HOST_COUNTERS *counters;
+    int core;
+    hostScope scope;
+
+    hostSample(HOST_COUNTERS *counters, int core, hostScope scope)
+        : counters(counters && counters->stages ? counters : nullptr), core(core), scope(scope){
+        if(this->counters){
+            this->counters->Begin(core, scope);
+        }
+    }
+    ~hostSample(){
+        if(counters){
+            counters->End(core, scope);
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "LIVE_STATS.h"
+#include "../PCB.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(MAX_CONTEXTS <= LIVE_CONTEXTS, "liveCore needs a pid per hardware context");
+
+LIVE_STATS::LIVE_STATS(int numCores) : numCores(numCores){
+}
+
+LIVE_STATS::~LIVE_STATS(){
+    if(segment != nullptr){
+        munmap(segment, sizeof(liveSegment));
+        shm_unlink(name.c_str());
+    }
+}
+
+// PID do simulador que criou o segmento existente com esse nome, 0 se ele não
+// chegou a gravar o cabeçalho.
+static pid_t segmentOwner(const string &name){
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if(fd < 0){
+        return 0;
+    }
+    struct stat info;
+    pid_t owner = 0;
+    if(fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(liveSegment)){
+        void *address = mmap(nullptr, sizeof(liveSegment), PROT_READ, MAP_SHARED, fd, 0);
+        if(address != MAP_FAILED){
+            const liveSegment *segment = static_cast<const liveSegment*>(address);
+            owner = segment->magic == LIVE_MAGIC ? segment->simulatorPid : 0;
+            munmap(address, sizeof(liveSegment));
+        }
+    }
+    close(fd);
+    return owner;
+}
+
+bool LIVE_STATS::Open(const string &name){
+    if(numCores > LIVE_MAX_CORES){
+        error = "at most " + to_string(LIVE_MAX_CORES) + " cores";
+        return false;
+    }
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0 && errno == EEXIST){
+        // só descarta o segmento que sobrou de uma execução interrompida
+        pid_t owner = segmentOwner(name);
+        if(owner > 0 && (kill(owner, 0) == 0 || errno == EPERM)){
+            error = "in use by simulator " + to_string(owner) + " (choose another name with --live=/name)";
+            return false;
+        }
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if(fd < 0){
+        error = strerror(errno);
+        return false;
+    }
+    if(ftruncate(fd, sizeof(liveSegment)) != 0){
+        error = strerror(errno);
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *address = mmap(nullptr, sizeof(liveSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(address == MAP_FAILED){
+        error = strerror(errno);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // o ftruncate zera o segmento: todas as sequências começam pares
+    this->name = name;
+    segment = static_cast<liveSegment*>(address);
+    segment->version = LIVE_VERSION;
+    segment->numCores = numCores;
+    segment->simulatorPid = getpid();
+    for(int i = 0; i < numCores; i++){
+        for(int context = 0; context < LIVE_CONTEXTS; context++){
+            segment->cores[i].pids[context].store(LIVE_NO_PID, memory_order_relaxed);
+        }
+    }
+    segment->global.running.store(1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    segment->magic = LIVE_MAGIC;
+
+    start = last = chrono::steady_clock::now();
+    return true;
+}
+
+// Chamado pela thread do núcleo ao receber processos.
+void LIVE_STATS::Running(int core, const vector<PCB*> &running, uint64_t time){
+    liveCore &slot = segment->cores[core];
+    liveWrite write(slot.sequence);
+    slot.state.store(LIVE_RUNNING, memory_order_relaxed);
+    for(size_t context = 0; context < LIVE_CONTEXTS; context++){
+        slot.pids[context].store(context < running.size() ? running[context]->id : LIVE_NO_PID, memory_order_relaxed);
+    }
+    slot.cycle.store(time, memory_order_relaxed);
+}
+
+// Chamado pela thread do núcleo ao devolver os processos, com os contadores do núcleo.
+void LIVE_STATS::Retire(int core, uint64_t time, const PIPELINE_COUNTERS &counters){
+    liveCore &slot = segment->cores[core];
+    liveWrite write(slot.sequence);
+    slot.state.store(LIVE_IDLE, memory_order_relaxed);
+    for(int context = 0; context < LIVE_CONTEXTS; context++){
+        slot.pids[context].store(LIVE_NO_PID, memory_order_relaxed);
+    }
+    slot.cycle.store(time, memory_order_relaxed);
+    slot.instructions.store(counters.instructions, memory_order_relaxed);
+    slot.quanta.store(counters.quanta, memory_order_relaxed);
+}
+
+// Conta os processos por estado, as filas de E/S e a memória. O escalonador
+// chama a cada volta; sem force só publica a cada LIVE_PUBLISH_MS.
+void LIVE_STATS::Publish(const scheduleInfo &info, bool force){
+    auto now = chrono::steady_clock::now();
+    if(!force && now - last < chrono::milliseconds(LIVE_PUBLISH_MS)){
+        return;
+    }
+    last = now;
+
+    uint64_t states[(int)State::Finished + 1] = {};
+    uint64_t used = 0, loaded = 0;
+    for(const auto &pcb : *info.processes){
+        states[(int)pcb->state] += 1;
+        if(pcb->state != State::Finished){
+            used += pcb->finalAddr - pcb->baseAddr;
+        }
+        loaded = max<uint64_t>(loaded, pcb->finalAddr);
+    }
+    uint64_t queued = 0, busy = 0, completed = 0;
+    for(const auto &device : info.io->devices){
+        queued += device->queue.Size();
+        busy += device->busy.load(memory_order_relaxed);
+        completed += device->queue.completed.load(memory_order_relaxed);
+    }
+
+    liveGlobal &global = segment->global;
+    liveWrite write(global.sequence);
+    global.cycle.store(info.clock->now.load(memory_order_relaxed), memory_order_relaxed);
+    global.wallMs.store(chrono::duration_cast<chrono::milliseconds>(now - start).count(), memory_order_relaxed);
+    global.processes.store(info.processes->size(), memory_order_relaxed);
+    global.arriving.store(states[(int)State::New], memory_order_relaxed);
+    global.ready.store(states[(int)State::Ready], memory_order_relaxed);
+    global.executing.store(states[(int)State::Executing], memory_order_relaxed);
+    global.blocked.store(states[(int)State::Blocked], memory_order_relaxed);
+    global.finished.store(states[(int)State::Finished], memory_order_relaxed);
+    global.ioQueued.store(queued, memory_order_relaxed);
+    global.ioBusy.store(busy, memory_order_relaxed);
+    global.ioCompleted.store(completed, memory_order_relaxed);
+    global.memoryUsed.store(used, memory_order_relaxed);
+    global.memoryLoaded.store(loaded, memory_order_relaxed);
+    global.memoryTotal.store((uint64_t)info.ram->NumOfi * info.ram->NumOfj, memory_order_relaxed);
+}
+
+// Última publicação, depois que as threads terminaram; o Monitor vê running = 0
+// e sai. O nome é removido no destrutor.
+void LIVE_STATS::Close(const scheduleInfo &info){
+    Publish(info, true);
+    liveWrite write(segment->global.sequence);
+    segment->global.running.store(0, memory_order_relaxed);
+}
@@ -0,0 +1,128 @@
+#ifndef LIVE_STATS_H
+#define LIVE_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define LIVE_MAGIC          0x4556494c      // "LIVE"
+#define LIVE_VERSION        1
+#define LIVE_MAX_CORES      256
+#define LIVE_CONTEXTS       4               // MAX_CONTEXTS
+#define LIVE_NO_PID         (-1)
+#define LIVE_PUBLISH_MS     10              // intervalo mínimo entre publicações da parte global
+#define LIVE_DEFAULT_NAME   "/CustomVonNeumannMachine"
+#define LIVE_READ_TRIES     100000          // cópias tentadas antes de desistir de uma leitura
+
+struct scheduleInfo;
+struct PCB;
+struct PIPELINE_COUNTERS;
+
+enum liveCoreState : uint32_t {
+    LIVE_IDLE,
+    LIVE_RUNNING
+};
+
+// Seqlock: o escritor deixa sequence ímpar enquanto escreve; o leitor copia os
+// campos e repete se a sequência era ímpar ou mudou no meio. Os campos são
+// atômicos relaxados, então a cópia nunca é uma corrida de dados, e o escritor
+// nunca espera o leitor.
+struct liveWrite {
+    atomic<uint32_t> &sequence;
+    uint32_t start;
+
+    liveWrite(atomic<uint32_t> &sequence) : sequence(sequence), start(sequence.load(memory_order_relaxed)){
+        sequence.store(start + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+    }
+    ~liveWrite(){
+        sequence.store(start + 2, memory_order_release);
+    }
+};
+
+// Falso se não conseguiu uma cópia consistente em LIVE_READ_TRIES tentativas:
+// um escritor que morreu no meio da escrita deixa a sequência ímpar para sempre.
+template<typename Copy>
+bool liveRead(const atomic<uint32_t> &sequence, Copy copy){
+    for(int tries = 0; tries < LIVE_READ_TRIES; tries++){
+        const uint32_t start = sequence.load(memory_order_acquire);
+        if(start & 1){
+            continue;
+        }
+        copy();
+        atomic_thread_fence(memory_order_acquire);
+        if(sequence.load(memory_order_relaxed) == start){
+            return true;
+        }
+    }
+    return false;
+}
+
+// Um núcleo, escrito só pela thread dele (ou pela fase serial do modo
+// determinístico). Uma linha de cache por núcleo, para os núcleos não
+// disputarem a mesma linha.
+struct alignas(64) liveCore {
+    atomic<uint32_t> sequence;
+    atomic<uint32_t> state;                 // liveCoreState
+    atomic<int32_t> pids[LIVE_CONTEXTS];    // processo em cada contexto, LIVE_NO_PID se vazio
+    atomic<uint64_t> cycle;                 // tempo local do núcleo
+    atomic<uint64_t> instructions;          // confirmadas desde o início
+    atomic<uint64_t> quanta;
+};
+
+// Estado do sistema, publicado pelo escalonador com queueLock adquirido.
+struct alignas(64) liveGlobal {
+    atomic<uint32_t> sequence;
+    atomic<uint32_t> running;               // 0 depois que a simulação terminou
+    atomic<uint64_t> cycle;                 // relógio virtual
+    atomic<uint64_t> wallMs;
+    atomic<uint64_t> processes;
+    atomic<uint64_t> arriving;              // State::New
+    atomic<uint64_t> ready;
+    atomic<uint64_t> executing;
+    atomic<uint64_t> blocked;
+    atomic<uint64_t> finished;
+    atomic<uint64_t> ioQueued;              // pedidos nas filas dos dispositivos
+    atomic<uint64_t> ioBusy;                // unidades de dispositivo atendendo
+    atomic<uint64_t> ioCompleted;
+    atomic<uint64_t> memoryUsed;            // palavras dos processos ainda não terminados
+    atomic<uint64_t> memoryLoaded;          // palavras de todos os programas carregados
+    atomic<uint64_t> memoryTotal;
+};
+
+// O segmento inteiro. magic é gravado por último na abertura: o Monitor só usa
+// um segmento com magic e versão certos.
+struct liveSegment {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numCores;
+    int32_t simulatorPid;
+    liveGlobal global;
+    liveCore cores[LIVE_MAX_CORES];
+};
+
+// Estatísticas ao vivo (--live) em um segmento de memória compartilhada
+// (shm_open), para o Monitor ler de outro processo enquanto a simulação roda.
+struct LIVE_STATS {
+    int numCores;
+    string name;
+    liveSegment *segment = nullptr;
+    string error;                   // motivo da falha do Open
+    chrono::steady_clock::time_point start;
+    chrono::steady_clock::time_point last;
+
+    LIVE_STATS(int numCores);
+    ~LIVE_STATS();
+
+    bool Open(const string &name);
+    void Running(int core, const vector<PCB*> &running, uint64_t time);
+    void Retire(int core, uint64_t time, const PIPELINE_COUNTERS &counters);
+    void Publish(const scheduleInfo &info, bool force = false);    // com queueLock adquirido
+    void Close(const scheduleInfo &info);
+};
+
+#endif
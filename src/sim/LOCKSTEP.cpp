@@ -0,0 +1,265 @@
+#include "LOCKSTEP.h"
+#include "../cpu/CONTROL_UNIT.h"
+
+#include <algorithm>
+#include <barrier>
+#include <pthread.h>
+
+struct lockstepCore {
+    vector<PCB*> processes;     // um por contexto de hardware
+    uint64_t localTime;
+};
+
+struct lockstepState;
+
+struct serialPhase {
+    lockstepState *state;
+    void operator()() noexcept;
+};
+
+struct lockstepState {
+    scheduleInfo *info;
+    vector<lockstepCore> cores;
+    uint64_t window;
+    uint64_t seed;
+    uint64_t windowStart;
+    uint64_t windowEnd;
+    uint64_t windows;
+    barrier<serialPhase> *sync;
+
+    void RunWindow(int core);
+    void Retire();
+    void FireEvents();
+    bool Finished();
+    void Assign();
+    void Serial();
+};
+
+struct lockstepArgs {
+    lockstepState *state;
+    int id;
+};
+
+static uint64_t mixSeed(uint64_t x)
+{
+    // splitmix64
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+void serialPhase::operator()() noexcept
+{
+    state->Serial();
+}
+
+static bool runnable(const PCB &process)
+{
+    return process.state == State::Executing && !process.waitingIO && !process.waitingDMA && process.waitingIOSpace < 0;
+}
+
+// Executada em paralelo: o núcleo roda os seus processos até o fim da janela,
+// ou até todos bloquearem ou terminarem. Nenhum estado compartilhado muda aqui.
+void lockstepState::RunWindow(int id)
+{
+    lockstepCore &core = cores[id];
+
+    if (core.processes.empty()) {
+        Idle_Interrupts(*info->interrupts[id], *info->io, core.localTime);
+        return;
+    }
+
+    coreResources resources = Core_Resources(*info, id);
+
+    vector<PCB*> running = core.processes;
+    while (core.localTime < windowEnd) {
+        erase_if(running, [](PCB *process) { return !runnable(*process); });
+        if (running.empty()) {
+            break;
+        }
+        if (resources.units.contexts > 1) {
+            Core_SMT(resources, running, core.localTime);
+        } else {
+            Core(resources, *running.front(), core.localTime);
+        }
+    }
+}
+
+// Devolve os processos dos núcleos para o escalonador, do núcleo 0 ao último.
+void lockstepState::Retire()
+{
+    IO_SUBSYSTEM &io = *info->io;
+    info->io->FlushStaged();
+
+    for (size_t i = 0; i < cores.size(); i++) {
+        lockstepCore &core = cores[i];
+        core.localTime = max(core.localTime, windowEnd);
+        info->clock->SetCoreTime(i, core.localTime);
+        if (info->live) {
+            info->live->Retire(i, core.localTime, info->pipelineCounters[i]);
+        }
+
+        for (PCB *process : core.processes) {
+            if (process->state == State::Executing) {
+                if (io.WaitPending(*process)) {
+                    process->state = State::Blocked;
+                } else {
+                    io.Release(*process, core.localTime);
+                }
+            }
+        }
+        core.processes.clear();
+    }
+}
+
+void lockstepState::FireEvents()
+{
+    SIM_CLOCK &clock = *info->clock;
+    clock.now = max(clock.now.load(), windowEnd);
+
+    uint64_t fired;
+    do {
+        fired = clock.eventsFired;
+        info->io->Dispatch();
+        clock.FireDue();
+    } while (fired != clock.eventsFired);
+}
+
+bool lockstepState::Finished()
+{
+    for (const auto &pcb : *info->processes) {
+        if (pcb->state != State::Finished || pcb->pendingIO > 0) {
+            return false;
+        }
+    }
+    return info->io->Idle();
+}
+
+// Entrega os processos prontos aos núcleos, em ordem de readyTime e, nos
+// empates, em uma ordem derivada da semente. Com SMT cada rodada dá um
+// processo a cada núcleo, até encher os contextos.
+void lockstepState::Assign()
+{
+    vector<PCB*> ready;
+    for (auto &pcb : *info->processes) {
+        if (pcb->state == State::Ready) {
+            ready.push_back(pcb.get());
+        }
+    }
+    sort(ready.begin(), ready.end(), [this](PCB *a, PCB *b) {
+        if (a->readyTime != b->readyTime) {
+            return a->readyTime < b->readyTime;
+        }
+        return mixSeed(seed ^ a->id) < mixSeed(seed ^ b->id);
+    });
+
+    size_t next = 0;
+    for (unsigned slot = 0; next < ready.size() && slot < MAX_CONTEXTS; slot++) {
+        for (size_t i = 0; i < cores.size() && next < ready.size(); i++) {
+            lockstepCore &core = cores[i];
+            if (slot >= info->executionUnits[i].contexts) {
+                continue;
+            }
+            PCB *process = ready[next++];
+            process->state = State::Executing;
+            core.processes.push_back(process);
+            core.localTime = max({core.localTime, process->readyTime, windowStart});
+        }
+    }
+
+    for (size_t i = 0; i < cores.size(); i++) {
+        lockstepCore &core = cores[i];
+        for (PCB *process : core.processes) {
+            process->readyWait += core.localTime - process->readyTime;
+            process->dispatches += 1;
+        }
+        if (info->live && !core.processes.empty()) {
+            info->live->Running(i, core.processes, core.localTime);
+        }
+    }
+}
+
+void lockstepState::Serial()
+{
+    Retire();
+    FireEvents();
+    windows += 1;
+
+    if (Finished()) {
+        info->shutdown = true;
+        return;
+    }
+
+    windowStart = windowEnd;
+    Assign();
+    if (info->live) {
+        info->live->Publish(*info);
+    }
+
+    bool busy = false;
+    for (const auto &core : cores) {
+        busy = busy || !core.processes.empty();
+    }
+    for (const auto &irq : info->interrupts) {
+        // interrupções levantadas na barreira são atendidas na próxima janela
+        busy = busy || irq->pendingMask != 0;
+    }
+    if (!busy) {
+        // nada para executar: salta até a janela do próximo evento
+        uint64_t next = info->clock->NextEventTime();
+        if (next == CORE_IDLE) {
+            cerr << "Lockstep: no runnable process and no pending event" << endl;
+            info->shutdown = true;
+            return;
+        }
+        windowStart = max(windowStart, next - next % window);
+    }
+    windowEnd = windowStart + window;
+}
+
+void* lockstepCoreThread(void *arg)
+{
+    lockstepArgs *args = static_cast<lockstepArgs*>(arg);
+    lockstepState *state = args->state;
+
+    while (!state->info->shutdown) {
+        state->RunWindow(args->id);
+        state->sync->arrive_and_wait();
+    }
+
+    return nullptr;
+}
+
+uint64_t runLockstep(scheduleInfo *info, int numCores, uint64_t window, uint64_t seed)
+{
+    lockstepState state;
+    state.info = info;
+    state.cores.assign(numCores, lockstepCore{{}, 0});
+    state.window = max<uint64_t>(1, window);
+    state.seed = seed;
+    state.windowStart = 0;
+    state.windowEnd = state.window;
+    state.windows = 0;
+
+    barrier<serialPhase> sync(numCores, serialPhase{&state});
+    state.sync = &sync;
+
+    info->io->EnableStaging(numCores);
+    state.Assign();
+
+    vector<pthread_t> threads(numCores);
+    vector<lockstepArgs> args(numCores);
+    for (int i = 0; i < numCores; i++) {
+        args[i] = lockstepArgs{&state, i};
+        if (pthread_create(&threads[i], nullptr, lockstepCoreThread, &args[i]) != 0) {
+            cerr << "Error creating core thread " << i << endl;
+            exit(1);
+        }
+    }
+    for (int i = 0; i < numCores; i++) {
+        pthread_join(threads[i], nullptr);
+    }
+
+    return state.windows;
+}
@@ -0,0 +1,17 @@
+#ifndef LOCKSTEP_H
+#define LOCKSTEP_H
+
+#include "../PCB.h"
+#include <cstdint>
+
+#define LOCKSTEP_WINDOW 64
+
+// Modo determinístico: cada núcleo simulado avança uma janela fixa de ciclos
+// em paralelo (uma thread por núcleo) e todos se encontram em uma barreira.
+// Na barreira, com os núcleos parados, os efeitos entre núcleos (pedidos de
+// E/S, eventos, troca de estado dos processos, escalonamento) são aplicados
+// sempre na mesma ordem, então execuções com a mesma semente produzem a
+// mesma saída e as mesmas estatísticas.
+uint64_t runLockstep(scheduleInfo *info, int numCores, uint64_t window, uint64_t seed);
+
+#endif
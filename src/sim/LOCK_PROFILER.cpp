@@ -0,0 +1,167 @@
+#include "LOCK_PROFILER.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+PROFILED_MUTEX::PROFILED_MUTEX(const string &name) : name(name){
+}
+
+lockSite& PROFILED_MUTEX::Site(const source_location &site){
+    for(lockSite &known : sites){
+        if(known.line == site.line() && known.file == site.file_name()){
+            return known;
+        }
+    }
+    sites.push_back(lockSite{site.file_name(), site.function_name(), site.line()});
+    return sites.back();
+}
+
+void PROFILED_MUTEX::Lock(const source_location &site){
+    if(!profiling){
+        m.lock();
+        return;
+    }
+    // só a espera de quem encontrou a trava ocupada é medida
+    uint64_t wait = 0;
+    if(m.try_lock()){
+        acquired = chrono::steady_clock::now();
+    }else{
+        auto start = chrono::steady_clock::now();
+        m.lock();
+        acquired = chrono::steady_clock::now();
+        wait = chrono::duration_cast<chrono::nanoseconds>(acquired - start).count();
+    }
+
+    holder = &Site(site);
+    holder->acquisitions += 1;
+    if(wait > 0){
+        holder->contended += 1;
+        holder->waitTotal += wait;
+        holder->waitMax = max(holder->waitMax, wait);
+    }
+    holder->waitHistogram[wait == 0 ? 0 : min<int>(LOCK_BUCKETS - 1, 64 - __builtin_clzll(wait))] += 1;
+}
+
+void PROFILED_MUTEX::Unlock(){
+    if(holder != nullptr){
+        uint64_t hold = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - acquired).count();
+        holder->holdTotal += hold;
+        holder->holdMax = max(holder->holdMax, hold);
+        holder = nullptr;
+    }
+    m.unlock();
+}
+
+static string duration(double ns){
+    ostringstream text;
+    text << fixed << setprecision(ns < 1000 ? 0 : 1);
+    if(ns < 1000){
+        text << ns << "ns";
+    }else if(ns < 1e6){
+        text << ns / 1e3 << "us";
+    }else if(ns < 1e9){
+        text << ns / 1e6 << "ms";
+    }else{
+        text << ns / 1e9 << "s";
+    }
+    return text.str();
+}
+
+// Limite superior do balde em que cai o percentil, sem passar da maior espera.
+static uint64_t percentile(const lockSite &site, double fraction){
+    uint64_t target = site.acquisitions * fraction, seen = 0;
+    for(int bucket = 0; bucket < LOCK_BUCKETS; bucket++){
+        seen += site.waitHistogram[bucket];
+        if(seen > target || bucket == LOCK_BUCKETS - 1){
+            return bucket == 0 ? 0 : min<uint64_t>(site.waitMax, (1ull << bucket) - 1);
+        }
+    }
+    return 0;
+}
+
+static void merge(lockSite &into, const lockSite &site){
+    into.acquisitions += site.acquisitions;
+    into.contended += site.contended;
+    into.waitTotal += site.waitTotal;
+    into.waitMax = max(into.waitMax, site.waitMax);
+    into.holdTotal += site.holdTotal;
+    into.holdMax = max(into.holdMax, site.holdMax);
+    for(int bucket = 0; bucket < LOCK_BUCKETS; bucket++){
+        into.waitHistogram[bucket] += site.waitHistogram[bucket];
+    }
+}
+
+void printLockStats(const vector<PROFILED_MUTEX*> &locks, chrono::milliseconds wallTime, ostream &out){
+    // por nome e, dentro dele, por arquivo e linha
+    map<string, pair<int, map<pair<string, uint32_t>, lockSite>>> merged;
+    for(const PROFILED_MUTEX *lock : locks){
+        auto &[count, sites] = merged[lock->name];
+        count += 1;
+        for(const lockSite &site : lock->sites){
+            auto [entry, added] = sites.try_emplace({site.file, site.line}, lockSite{site.file, site.function, site.line});
+            merge(entry->second, site);
+        }
+    }
+
+    const double wallNs = wallTime.count() * 1e6;
+    out << "Lock contention (wall time " << wallTime.count() << " ms):" << endl;
+    for(const auto &[name, entry] : merged){
+        const auto &[count, sites] = entry;
+        lockSite total{"", "", 0};
+        for(const auto &[key, site] : sites){
+            merge(total, site);
+        }
+        out << fixed << setprecision(1);
+        out << "  " << name;
+        if(count > 1){
+            out << " (" << count << " locks)";
+        }
+        // espera e posse somam o tempo de todas as threads: 2.0x é o equivalente a
+        // duas threads paradas na trava a execução inteira
+        out << ": " << total.acquisitions << " acquisitions, " << total.contended << " contended ("
+            << (total.acquisitions ? 100.0 * total.contended / total.acquisitions : 0.0) << "%), waited "
+            << duration(total.waitTotal) << " of thread time (" << (wallNs > 0 ? total.waitTotal / wallNs : 0.0)
+            << "x wall), held " << duration(total.holdTotal) << " of thread time ("
+            << (wallNs > 0 ? total.holdTotal / wallNs : 0.0) << "x wall)" << endl;
+        if(total.acquisitions == 0){
+            continue;
+        }
+
+        out << "    wait histogram (acquisitions):";
+        for(int bucket = 0; bucket < LOCK_BUCKETS; bucket++){
+            if(total.waitHistogram[bucket] > 0){
+                string range = bucket == 0 ? "none" : "<" + duration(1ull << bucket);
+                if(bucket == LOCK_BUCKETS - 1){
+                    range = ">=" + duration(1ull << (bucket - 1));
+                }
+                out << " " << range << " " << total.waitHistogram[bucket];
+            }
+        }
+        out << endl;
+
+        vector<const lockSite*> sorted;
+        for(const auto &[key, site] : sites){
+            sorted.push_back(&site);
+        }
+        sort(sorted.begin(), sorted.end(), [](const lockSite *a, const lockSite *b){
+            return a->waitTotal != b->waitTotal ? a->waitTotal > b->waitTotal : a->acquisitions > b->acquisitions;
+        });
+        out << "    " << setw(28) << left << "site" << right << setw(12) << "acquired" << setw(11) << "contended"
+            << setw(10) << "wait avg" << setw(10) << "p99" << setw(10) << "max" << setw(10) << "hold avg"
+            << setw(10) << "max" << "  function" << endl;
+        for(const lockSite *site : sorted){
+            const char *file = strrchr(site->file, '/');
+            string where = string(file ? file + 1 : site->file) + ":" + to_string(site->line);
+            out << "    " << setw(28) << left << where << right << setw(12) << site->acquisitions
+                << setw(10) << 100.0 * site->contended / site->acquisitions << "%"
+                << setw(10) << duration((double)site->waitTotal / site->acquisitions)
+                << setw(10) << duration(percentile(*site, 0.99)) << setw(10) << duration(site->waitMax)
+                << setw(10) << duration((double)site->holdTotal / site->acquisitions)
+                << setw(10) << duration(site->holdMax) << "  " << site->function << endl;
+        }
+    }
+    out << defaultfloat;
+}
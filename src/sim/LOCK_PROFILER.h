@@ -0,0 +1,68 @@
+#ifndef LOCK_PROFILER_H
+#define LOCK_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define LOCK_BUCKETS 32     // espera em ns: 0, 1, 2-3, 4-7, ... e o resto no último
+
+// Estatísticas de um ponto do código que adquire a trava.
+struct lockSite {
+    const char *file;
+    const char *function;
+    uint32_t line;
+    uint64_t acquisitions = 0;
+    uint64_t contended = 0;             // o try_lock falhou e a thread esperou
+    uint64_t waitTotal = 0;             // ns
+    uint64_t waitMax = 0;
+    uint64_t holdTotal = 0;
+    uint64_t holdMax = 0;
+    uint64_t waitHistogram[LOCK_BUCKETS] = {};
+};
+
+// mutex com contadores de contenção (--lock-stats). As estatísticas são
+// atualizadas com a própria trava adquirida, então não precisam de outra
+// sincronização. Sem profiling é só o mutex e um teste.
+struct PROFILED_MUTEX {
+    string name;
+    bool profiling = false;
+    mutex m;
+    vector<lockSite> sites;
+    lockSite *holder = nullptr;         // ponto que detém a trava agora
+    chrono::steady_clock::time_point acquired;
+
+    PROFILED_MUTEX(const string &name);
+
+    void Lock(const source_location &site);
+    void Unlock();
+
+private:
+    lockSite& Site(const source_location &site);
+};
+
+// lock_guard do PROFILED_MUTEX: o ponto de chamada vem do argumento padrão,
+// avaliado onde o guard é construído.
+struct profiledGuard {
+    PROFILED_MUTEX &lock;
+
+    profiledGuard(PROFILED_MUTEX &lock, const source_location &site = source_location::current()) : lock(lock){
+        lock.Lock(site);
+    }
+    ~profiledGuard(){
+        lock.Unlock();
+    }
+    profiledGuard(const profiledGuard&) = delete;
+    profiledGuard& operator=(const profiledGuard&) = delete;
+};
+
+// Travas com o mesmo nome (um controlador de interrupção por núcleo) saem somadas.
+void printLockStats(const vector<PROFILED_MUTEX*> &locks, chrono::milliseconds wallTime, ostream &out);
+
+#endif
@@ -0,0 +1,164 @@
+#include "PROFILER.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+
+PROFILER::PROFILER(int numCores, uint64_t interval) : interval(max<uint64_t>(1, interval)), cores(numCores) {}
+
+void PROFILER::AddProgram(int pid, const string &name, const map<uint32_t, string> &labels){
+    programs[pid] = profiledProgram{name, labels, {}, 0};
+}
+
+// Núcleo volta a ter processo: as amostras seguem a partir do tempo atual, sem
+// recuperar os ciclos em que ele ficou ocioso.
+void PROFILER::Resume(int core, uint64_t time){
+    uint64_t &next = cores[core].next;
+    if(next <= time){
+        next = time - time % interval + interval;
+    }
+}
+
+// Registra as amostras vencidas até `time` no pc da instrução que acabou de
+// passar pelo núcleo, então uma instrução longa recebe tantas amostras quanto
+// os ciclos que ocupou.
+void PROFILER::Tick(int core, int pid, uint32_t pc, uint64_t time){
+    profilerCore &state = cores[core];
+    if(state.next > time){
+        return;
+    }
+    auto entry = programs.find(pid);
+    if(entry == programs.end()){
+        return;
+    }
+    const profiledProgram &program = entry->second;
+
+    // no ciclo do próprio jal a função chamada ainda não começou
+    size_t depth = program.calls.size();
+    if(depth > 0 && program.calls.back().site == pc){
+        depth -= 1;
+    }
+    string stack = to_string(pid) + "\t" + program.name;
+    string last;
+    for(size_t i = 0; i < depth; i++){
+        last = Label(program, program.calls[i].target);
+        stack += ";" + last;
+    }
+    string leaf = pc == PROFILE_INTERRUPT ? "[interrupt]" : Label(program, pc);
+    if(leaf != last){
+        stack += ";" + leaf;
+    }
+
+    uint64_t samples = (time - state.next) / interval + 1;
+    state.stacks[stack] += samples;
+    state.next += samples * interval;
+}
+
+void PROFILER::Call(int pid, uint32_t site, uint32_t target){
+    auto entry = programs.find(pid);
+    if(entry == programs.end()){
+        return;
+    }
+    profiledProgram &program = entry->second;
+    if(program.calls.size() < PROFILE_MAX_DEPTH){
+        program.calls.push_back(profiledCall{site, target});
+    }else{
+        program.overflow += 1;
+    }
+}
+
+void PROFILER::Return(int pid){
+    auto entry = programs.find(pid);
+    if(entry == programs.end()){
+        return;
+    }
+    profiledProgram &program = entry->second;
+    if(program.overflow > 0){
+        program.overflow -= 1;
+    }else if(!program.calls.empty()){
+        program.calls.pop_back();
+    }
+}
+
+// Label mais próximo no endereço do pc ou antes dele.
+string PROFILER::Label(const profiledProgram &program, uint32_t pc) const{
+    auto label = program.labels.upper_bound(pc);
+    if(label == program.labels.begin()){
+        return "?";
+    }
+    return prev(label)->second;
+}
+
+// Por processo, os labels com mais amostras: self conta o pc dentro do label e
+// inclusive também as funções chamadas a partir dele.
+void PROFILER::PrintHotSpots(ostream &out, size_t rows) const{
+    map<int, uint64_t> total;
+    map<int, map<string, uint64_t>> self;
+    map<int, map<string, uint64_t>> inclusive;
+
+    for(const profilerCore &core : cores){
+        for(const auto &[key, samples] : core.stacks){
+            size_t tab = key.find('\t');
+            int pid = stoi(key.substr(0, tab));
+            vector<string> frames;
+            stringstream stack(key.substr(tab + 1));
+            string frame;
+            getline(stack, frame, ';');     // nome do programa
+            while(getline(stack, frame, ';')){
+                frames.push_back(frame);
+            }
+
+            total[pid] += samples;
+            self[pid][frames.back()] += samples;
+            set<string> seen(frames.begin(), frames.end());
+            for(const string &label : seen){
+                inclusive[pid][label] += samples;
+            }
+        }
+    }
+
+    uint64_t samples = 0;
+    for(const auto &[pid, count] : total){
+        samples += count;
+    }
+    out << "Profile: " << samples << " samples, one every " << interval << " cycles" << endl;
+
+    for(const auto &[pid, count] : total){
+        out << "[process " << pid << " " << programs.at(pid).name << "] " << count << " samples" << endl;
+        vector<pair<string, uint64_t>> labels(inclusive[pid].begin(), inclusive[pid].end());
+        sort(labels.begin(), labels.end(), [&](const auto &a, const auto &b){
+            uint64_t selfA = self[pid][a.first], selfB = self[pid][b.first];
+            return selfA != selfB ? selfA > selfB : a.second > b.second;
+        });
+        out << "     self  inclusive  label" << endl;
+        for(size_t i = 0; i < labels.size() && i < rows; i++){
+            out << fixed << setprecision(1)
+                << setw(8) << 100.0 * self[pid][labels[i].first] / count << "%"
+                << setw(10) << 100.0 * labels[i].second / count << "%  " << labels[i].first << endl;
+        }
+        out << defaultfloat;
+    }
+}
+
+// Formato "folded" dos scripts de flamegraph: uma pilha por linha, frames
+// separados por ';' e o número de amostras no fim. Processos do mesmo
+// programa são somados.
+bool PROFILER::WriteFolded(const string &path) const{
+    map<string, uint64_t> folded;
+    for(const profilerCore &core : cores){
+        for(const auto &[key, samples] : core.stacks){
+            folded[key.substr(key.find('\t') + 1)] += samples;
+        }
+    }
+
+    ofstream file(path);
+    if(!file){
+        return false;
+    }
+    for(const auto &[stack, samples] : folded){
+        file << stack << " " << samples << "\n";
+    }
+    return file.good();
+}
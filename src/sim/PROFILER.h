@@ -0,0 +1,56 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+#define PROFILE_INTERRUPT UINT32_MAX    // pc das amostras tiradas em tratadores de interrupção
+#define PROFILE_MAX_DEPTH 64            // chamadas aninhadas guardadas por processo
+
+struct profiledCall {
+    uint32_t site;                      // endereço do jal
+    uint32_t target;
+};
+
+struct profiledProgram {
+    string name;
+    map<uint32_t, string> labels;       // labelAddresses do loader
+    vector<profiledCall> calls;         // jal ainda sem retorno
+    unsigned overflow = 0;              // chamadas além de PROFILE_MAX_DEPTH
+};
+
+struct profilerCore {
+    uint64_t next = 0;                  // ciclo da próxima amostra
+    unordered_map<string, uint64_t> stacks;     // "pid\tprograma;função;...;label" -> amostras
+};
+
+// Profiler por amostragem dos programas simulados. A cada `interval` ciclos do
+// tempo local de um núcleo ocupado, o pc do processo em execução vira uma
+// amostra, com a pilha de chamadas seguida pelos jal e jr $ra e o label que
+// contém o pc. Cada núcleo amostra no seu próprio mapa, sem trava; os mapas só
+// são juntados no relatório, com a simulação encerrada.
+struct PROFILER {
+    uint64_t interval;
+    unordered_map<int, profiledProgram> programs;   // por id do processo, preenchido antes da simulação
+    vector<profilerCore> cores;
+
+    PROFILER(int numCores, uint64_t interval);
+
+    void AddProgram(int pid, const string &name, const map<uint32_t, string> &labels);
+    void Resume(int core, uint64_t time);
+    void Tick(int core, int pid, uint32_t pc, uint64_t time);
+    void Call(int pid, uint32_t site, uint32_t target);
+    void Return(int pid);
+
+    string Label(const profiledProgram &program, uint32_t pc) const;
+    void PrintHotSpots(ostream &out, size_t rows) const;
+    bool WriteFolded(const string &path) const;
+};
+
+#endif
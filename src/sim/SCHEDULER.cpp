@@ -0,0 +1,161 @@
+#include "SCHEDULER.h"
+#include "../cpu/CONTROL_UNIT.h"
+
+#include <sched.h>
+#include <vector>
+
+using namespace std;
+
+// Uma rodada do núcleo: pega um processo pronto para cada contexto de hardware,
+// roda um quantum e devolve os processos ao escalonador. Retorna se algum
+// processo rodou.
+bool coreDispatch(scheduleInfo* info, int coreId, uint64_t& localTime) {
+    EXECUTION_UNITS& units = info->executionUnits[coreId];
+    vector<PCB*> running;
+
+    {
+        profiledGuard lock(*info->queueLock);
+
+        
+        // Find a ready process for each hardware context
+        for (auto& pcb : *info->processes) {
+            if (pcb->state == State::Ready && running.size() < units.contexts) {
+                pcb->state = State::Executing;
+                running.push_back(pcb.get());
+            }
+        }
+
+        if (!running.empty()) {
+            localTime = max(localTime, info->clock->now.load());
+            for (PCB* process : running) {
+                localTime = max(localTime, process->readyTime);
+            }
+            for (PCB* process : running) {
+                process->readyWait += localTime - process->readyTime;
+                process->dispatches += 1;
+            }
+            info->clock->SetCoreTime(coreId, localTime);
+        } else {
+            info->clock->SetCoreIdle(coreId);
+        }
+    }
+
+    INTERRUPT_CONTROLLER& irq = *info->interrupts[coreId];
+
+    if (running.empty() && irq.pendingMask != 0) {
+        // núcleo ocioso: atende as conclusões de E/S roteadas para ele
+        localTime = max(localTime, info->clock->now.load());
+        Idle_Interrupts(irq, *info->io, localTime);
+    }
+
+    if (!running.empty()) {
+        if (info->live) {
+            info->live->Running(coreId, running, localTime);
+        }
+        coreResources core = Core_Resources(*info, coreId);
+        if (units.contexts > 1) {
+            Core_SMT(core, running, localTime);
+        } else {
+            Core(core, *running.front(), localTime);
+        }
+        info->clock->SetCoreTime(coreId, localTime);
+        if (info->live) {
+            info->live->Retire(coreId, localTime, info->pipelineCounters[coreId]);
+        }
+
+        profiledGuard lock(*info->queueLock);
+        for (PCB* currentProcess : running) {
+            if (currentProcess->state == State::Executing) {
+                if (info->io->WaitPending(*currentProcess)) {
+                    currentProcess->state = State::Blocked;
+                } else {
+                    info->io->Release(*currentProcess, localTime);
+                }
+            }
+        }
+    }
+
+    return !running.empty();
+}
+
+void* coreManage(void* arg) {
+    coreArgs* args = static_cast<coreArgs*>(arg);
+    scheduleInfo* info = args->info;
+    int coreId = args->id;
+    uint64_t localTime = 0;
+
+    while (!info->shutdown) {
+        coreDispatch(info, coreId, localTime);
+    }
+
+    return nullptr;
+}
+
+// Avança o relógio virtual: entrega pedidos aos dispositivos livres, dispara os
+// eventos vencidos e, se nenhum núcleo tem trabalho, salta até o próximo evento.
+// Uma volta que não mexeu no relógio cede a CPU aos núcleos.
+void* clockManage(void* arg) {
+    scheduleInfo* info = static_cast<scheduleInfo*>(arg);
+
+    while (!info->shutdown) {
+        const uint64_t now = info->clock->now.load();
+        const uint64_t fired = info->clock->eventsFired.load();
+        info->io->Dispatch();
+
+        // o salto só é usado com todos os núcleos ociosos; só aí vale olhar a fila
+        bool canSkip = info->clock->GlobalTime() == CORE_IDLE;
+        if (canSkip) {
+            profiledGuard lock(*info->queueLock);
+            for (const auto& pcb : *info->processes) {
+                if (pcb->state == State::Ready || pcb->state == State::Executing) {
+                    canSkip = false;
+                    break;
+                }
+            }
+            if (info->clock->GlobalTime() != CORE_IDLE) {
+                canSkip = false;
+            }
+        }
+
+        info->clock->Advance(canSkip);
+        info->clock->FireDue();
+
+        if (info->clock->now.load() == now && info->clock->eventsFired.load() == fired) {
+            sched_yield();
+        }
+    }
+
+    return nullptr;
+}
+
+void* scheduler(void* arg) {
+    scheduleInfo* info = static_cast<scheduleInfo*>(arg);
+
+    while (!info->shutdown) {
+        profiledGuard lock(*info->queueLock);
+
+        bool allDone = true;
+        
+        for (const auto& pcb : *info->processes) {
+            if (pcb->state != State::Finished || pcb->pendingIO > 0) {
+                allDone = false;
+                break;
+            }
+        }
+
+        if(!info->io->Idle()){
+            allDone = false;
+        }
+                
+        if (info->live) {
+            info->live->Publish(*info);
+        }
+
+        if (allDone) {
+            //cout << "Shutdown" << endl;
+            info->shutdown = true;
+        }
+    }
+
+    return nullptr;
+}
@@ -0,0 +1,20 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "../PCB.h"
+#include <cstdint>
+
+struct coreArgs {
+    scheduleInfo* info;
+    int id;
+};
+
+// Modo com threads: uma thread por núcleo (coreManage), o relógio virtual
+// (clockManage) e o escalonador, que encerra a simulação quando todos os
+// processos terminam.
+bool coreDispatch(scheduleInfo* info, int coreId, uint64_t& localTime);
+void* coreManage(void* arg);
+void* clockManage(void* arg);
+void* scheduler(void* arg);
+
+#endif
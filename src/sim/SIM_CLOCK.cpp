@@ -0,0 +1,95 @@
+#include "SIM_CLOCK.h"
+
+static void UpdateMax(atomic<uint64_t> &target, uint64_t value)
+{
+    uint64_t current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+SIM_CLOCK::SIM_CLOCK(int numCores) : now(0), horizon(0), numCores(numCores), eventLock("eventLock"), nextSeq(0), eventsFired(0)
+{
+    coreTime = make_unique<atomic<uint64_t>[]>(numCores);
+    for (int i = 0; i < numCores; i++) {
+        coreTime[i].store(CORE_IDLE);
+    }
+}
+
+void SIM_CLOCK::Schedule(uint64_t time, function<void()> action)
+{
+    profiledGuard lock(eventLock);
+    events.push(simEvent{time, nextSeq++, move(action)});
+}
+
+bool SIM_CLOCK::HasEvents()
+{
+    profiledGuard lock(eventLock);
+    return !events.empty();
+}
+
+uint64_t SIM_CLOCK::NextEventTime()
+{
+    profiledGuard lock(eventLock);
+    return events.empty() ? CORE_IDLE : events.top().time;
+}
+
+void SIM_CLOCK::SetCoreTime(int core, uint64_t time)
+{
+    coreTime[core].store(time);
+    UpdateMax(horizon, time);
+}
+
+void SIM_CLOCK::SetCoreIdle(int core)
+{
+    coreTime[core].store(CORE_IDLE);
+}
+
+uint64_t SIM_CLOCK::GlobalTime() const
+{
+    uint64_t global = CORE_IDLE;
+    for (int i = 0; i < numCores; i++) {
+        global = min(global, coreTime[i].load());
+    }
+    return global;
+}
+
+// Avança o tempo global. canSkip indica que não há processo pronto nem
+// núcleo ocupado, então o relógio pode saltar até o próximo evento.
+void SIM_CLOCK::Advance(bool canSkip)
+{
+    uint64_t global = GlobalTime();
+
+    if (global == CORE_IDLE) {
+        if (!canSkip) {
+            return;
+        }
+        global = NextEventTime();
+        if (global == CORE_IDLE) {
+            return;
+        }
+    }
+
+    UpdateMax(now, global);
+}
+
+void SIM_CLOCK::FireDue()
+{
+    while (true) {
+        simEvent event;
+        {
+            profiledGuard lock(eventLock);
+            if (events.empty() || events.top().time > now.load()) {
+                return;
+            }
+            event = events.top();
+            events.pop();
+        }
+        event.action();
+        eventsFired += 1;
+    }
+}
+
+uint64_t SIM_CLOCK::FinalTime() const
+{
+    return max(now.load(), horizon.load());
+}
@@ -0,0 +1,59 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include "LOCK_PROFILER.h"
+#include <queue>
+#include <vector>
+
+using namespace std;
+
+#define CORE_IDLE UINT64_MAX
+
+struct simEvent {
+    uint64_t time;
+    uint64_t seq;       // desempate: eventos no mesmo ciclo saem na ordem de agendamento
+    function<void()> action;
+};
+
+struct simEventLater {
+    bool operator()(const simEvent &a, const simEvent &b) const {
+        return a.time != b.time ? a.time > b.time : a.seq > b.seq;
+    }
+};
+
+// Relógio global simulado, medido em ciclos virtuais. Cada núcleo tem o seu
+// tempo local, que avança com os ciclos executados; o tempo global é o menor
+// tempo entre os núcleos ocupados. Eventos (conclusão de E/S, chegada de
+// processos...) disparam quando o tempo global alcança o ciclo agendado.
+// Quando nenhum núcleo tem trabalho o relógio salta direto para o próximo
+// evento, sem esperar tempo real.
+struct SIM_CLOCK {
+    atomic<uint64_t> now;
+    atomic<uint64_t> horizon;                  // maior tempo local já alcançado por um núcleo
+    unique_ptr<atomic<uint64_t>[]> coreTime;   // CORE_IDLE quando o núcleo está ocioso
+    int numCores;
+
+    PROFILED_MUTEX eventLock;
+    priority_queue<simEvent, vector<simEvent>, simEventLater> events;
+    uint64_t nextSeq;
+    atomic<uint64_t> eventsFired;
+
+    SIM_CLOCK(int numCores);
+
+    void Schedule(uint64_t time, function<void()> action);
+    bool HasEvents();
+    uint64_t NextEventTime();
+
+    void SetCoreTime(int core, uint64_t time);
+    void SetCoreIdle(int core);
+    uint64_t GlobalTime() const;
+    void Advance(bool canSkip);
+    void FireDue();
+    uint64_t FinalTime() const;
+};
+
+#endif
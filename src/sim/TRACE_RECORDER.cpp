@@ -0,0 +1,104 @@
+#include "TRACE_RECORDER.h"
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <sched.h>
+#include <unistd.h>
+
+static void* traceFlusher(void *arg){
+    TRACE_RECORDER *recorder = static_cast<TRACE_RECORDER*>(arg);
+    while(!recorder->stop.load(memory_order_acquire)){
+        if(recorder->Drain() == 0){
+            usleep(500);
+        }
+    }
+    recorder->Drain();
+    return nullptr;
+}
+
+TRACE_RECORDER::TRACE_RECORDER(int numCores) : rings(new traceRing[numCores]), numCores(numCores){
+    for(int i = 0; i < numCores; i++){
+        rings[i].slots.resize(TRACE_RING_RECORDS);
+    }
+}
+
+TRACE_RECORDER::~TRACE_RECORDER(){
+    if(file != nullptr){
+        stop = true;
+        pthread_join(flusher, nullptr);
+        fclose(file);
+    }
+}
+
+bool TRACE_RECORDER::Open(const string &path, const map<uint8_t, string> &opcodes){
+    file = fopen(path.c_str(), "wb");
+    if(file == nullptr){
+        return false;
+    }
+
+    traceHeader header{TRACE_MAGIC, TRACE_VERSION, sizeof(traceRecord), (uint32_t)opcodes.size()};
+    fwrite(&header, sizeof(header), 1, file);
+    for(const auto &[code, name] : opcodes){
+        traceOpcode entry{code, {}};
+        strncpy(entry.name, name.c_str(), sizeof(entry.name) - 1);
+        fwrite(&entry, sizeof(entry), 1, file);
+    }
+
+    if(pthread_create(&flusher, nullptr, traceFlusher, this) != 0){
+        fclose(file);
+        file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// Chamado só pela thread do núcleo.
+void TRACE_RECORDER::Record(int core, const traceRecord &record){
+    traceRing &ring = rings[core];
+    const uint64_t head = ring.head.load(memory_order_relaxed);
+    if(head - ring.tail.load(memory_order_acquire) == TRACE_RING_RECORDS){
+        ring.waits += 1;
+        while(head - ring.tail.load(memory_order_acquire) == TRACE_RING_RECORDS){
+            sched_yield();
+        }
+    }
+    ring.slots[head & (TRACE_RING_RECORDS - 1)] = record;
+    ring.head.store(head + 1, memory_order_release);
+}
+
+// Copia para o arquivo o que os núcleos já publicaram; devolve quantos registros.
+size_t TRACE_RECORDER::Drain(){
+    size_t copied = 0;
+    for(int i = 0; i < numCores; i++){
+        traceRing &ring = rings[i];
+        const uint64_t head = ring.head.load(memory_order_acquire);
+        uint64_t tail = ring.tail.load(memory_order_relaxed);
+        while(tail < head){
+            size_t start = tail & (TRACE_RING_RECORDS - 1);
+            size_t count = min<uint64_t>(head - tail, TRACE_RING_RECORDS - start);
+            fwrite(&ring.slots[start], sizeof(traceRecord), count, file);
+            tail += count;
+            copied += count;
+        }
+        ring.tail.store(tail, memory_order_release);
+    }
+    written += copied;
+    return copied;
+}
+
+void TRACE_RECORDER::Close(ostream &out){
+    if(file == nullptr){
+        return;
+    }
+    stop.store(true, memory_order_release);
+    pthread_join(flusher, nullptr);
+    fclose(file);
+    file = nullptr;
+
+    uint64_t waits = 0;
+    for(int i = 0; i < numCores; i++){
+        waits += rings[i].waits;
+    }
+    out << "Trace: " << written << " records, " << waits << " waited for ring space" << endl;
+}
@@ -0,0 +1,88 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <pthread.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define TRACE_MAGIC         0x43525456      // "VTRC"
+#define TRACE_VERSION       1
+#define TRACE_RING_RECORDS  (1 << 16)       // registros por núcleo, potência de 2
+#define TRACE_NO_REGISTER   0xFF
+#define TRACE_VL            32              // vl no lugar de um registrador de uso geral
+#define TRACE_OPERANDS      4
+
+enum traceFlags : uint8_t {
+    TRACE_LOAD   = 1,
+    TRACE_STORE  = 2,
+    TRACE_BRANCH = 4,       // desvio, j, jal ou jr
+    TRACE_TAKEN  = 8
+};
+
+// Uma instrução executada. address é o endereço efetivo de um acesso à
+// memória ou o destino de um desvio.
+struct traceRecord {
+    uint64_t cycle;
+    uint32_t pc;
+    uint32_t address;
+    uint16_t pid;
+    uint8_t core;
+    uint8_t opcode;
+    uint8_t flags;
+    uint8_t destination;                    // número do registrador ou TRACE_NO_REGISTER
+    uint8_t sources[TRACE_OPERANDS];
+    uint8_t reserved[6];
+};
+static_assert(sizeof(traceRecord) == 32, "traceRecord must stay 32 bytes");
+
+// Arquivo: cabeçalho, a tabela de opcodes (código e nome com 16 bytes) e os
+// registros na ordem em que saíram dos anéis: em ordem dentro de um núcleo,
+// intercalados entre núcleos.
+struct traceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t opcodeCount;
+};
+
+struct traceOpcode {
+    uint8_t code;
+    char name[15];
+};
+
+// Anel de um núcleo: só o núcleo escreve head e só o flusher escreve tail.
+struct traceRing {
+    vector<traceRecord> slots;
+    atomic<uint64_t> head{0};
+    atomic<uint64_t> tail{0};
+    uint64_t waits = 0;                     // registros que esperaram o anel ter espaço
+};
+
+// Gravador do trace de execução (--trace). Cada núcleo grava no seu anel sem
+// trava e uma thread copia os anéis para o arquivo em segundo plano. Com o
+// anel cheio o núcleo espera o flusher, então nenhum registro é perdido.
+struct TRACE_RECORDER {
+    unique_ptr<traceRing[]> rings;
+    int numCores;
+    FILE *file = nullptr;
+    pthread_t flusher;
+    atomic<bool> stop{false};
+    uint64_t written = 0;
+
+    TRACE_RECORDER(int numCores);
+    ~TRACE_RECORDER();
+
+    bool Open(const string &path, const map<uint8_t, string> &opcodes);
+    void Record(int core, const traceRecord &record);
+    size_t Drain();
+    void Close(ostream &out);
+};
+
+#endif
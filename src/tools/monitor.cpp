@@ -0,0 +1,228 @@
+// Monitor no estilo do top para uma simulação rodando com --live: lê o segmento
+// de memória compartilhada a cada intervalo e mostra o estado de cada núcleo,
+// as filas de processos, a E/S e a memória. Só lê o segmento, então não trava
+// nem atrasa o simulador.
+#include "../sim/LIVE_STATS.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <iomanip>
+#include <iostream>
+#include <sys/mman.h>
+#include <unistd.h>
+
+struct coreView {
+    uint32_t state;
+    int32_t pids[LIVE_CONTEXTS];
+    uint64_t cycle;
+    uint64_t instructions;
+    uint64_t quanta;
+};
+
+struct globalView {
+    uint32_t running;
+    uint64_t cycle, wallMs;
+    uint64_t processes, arriving, ready, executing, blocked, finished;
+    uint64_t ioQueued, ioBusy, ioCompleted;
+    uint64_t memoryUsed, memoryLoaded, memoryTotal;
+};
+
+// Só troca view por uma cópia consistente.
+static bool readGlobal(const liveGlobal &global, globalView &result){
+    globalView view;
+    bool read = liveRead(global.sequence, [&]{
+        view.running = global.running.load(memory_order_relaxed);
+        view.cycle = global.cycle.load(memory_order_relaxed);
+        view.wallMs = global.wallMs.load(memory_order_relaxed);
+        view.processes = global.processes.load(memory_order_relaxed);
+        view.arriving = global.arriving.load(memory_order_relaxed);
+        view.ready = global.ready.load(memory_order_relaxed);
+        view.executing = global.executing.load(memory_order_relaxed);
+        view.blocked = global.blocked.load(memory_order_relaxed);
+        view.finished = global.finished.load(memory_order_relaxed);
+        view.ioQueued = global.ioQueued.load(memory_order_relaxed);
+        view.ioBusy = global.ioBusy.load(memory_order_relaxed);
+        view.ioCompleted = global.ioCompleted.load(memory_order_relaxed);
+        view.memoryUsed = global.memoryUsed.load(memory_order_relaxed);
+        view.memoryLoaded = global.memoryLoaded.load(memory_order_relaxed);
+        view.memoryTotal = global.memoryTotal.load(memory_order_relaxed);
+    });
+    if(read){
+        result = view;
+    }
+    return read;
+}
+
+static bool readCore(const liveCore &core, coreView &result){
+    coreView view;
+    bool read = liveRead(core.sequence, [&]{
+        view.state = core.state.load(memory_order_relaxed);
+        for(int context = 0; context < LIVE_CONTEXTS; context++){
+            view.pids[context] = core.pids[context].load(memory_order_relaxed);
+        }
+        view.cycle = core.cycle.load(memory_order_relaxed);
+        view.instructions = core.instructions.load(memory_order_relaxed);
+        view.quanta = core.quanta.load(memory_order_relaxed);
+    });
+    if(read){
+        result = view;
+    }
+    return read;
+}
+
+static bool simulatorAlive(const liveSegment &segment){
+    return !(kill(segment.simulatorPid, 0) != 0 && errno == ESRCH);
+}
+
+// Lê o segmento inteiro. Uma parte que não deu uma cópia consistente fica com o
+// valor anterior; falso se o simulador morreu (possivelmente no meio de uma escrita).
+static bool readSegment(const liveSegment &segment, globalView &global, vector<coreView> &cores){
+    bool consistent = readGlobal(segment.global, global);
+    for(size_t i = 0; i < cores.size(); i++){
+        consistent = readCore(segment.cores[i], cores[i]) && consistent;
+    }
+    return consistent || simulatorAlive(segment);
+}
+
+// Espera o simulador criar o segmento e gravar o magic.
+static const liveSegment* attach(const string &name, unsigned interval, bool once){
+    bool warned = false;
+    for(;;){
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if(fd >= 0){
+            void *address = mmap(nullptr, sizeof(liveSegment), PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if(address == MAP_FAILED){
+                cerr << "Error mapping " << name << ": " << strerror(errno) << endl;
+                return nullptr;
+            }
+            const liveSegment *segment = static_cast<const liveSegment*>(address);
+            // o simulador grava magic logo depois de criar o segmento; sem ele em 1 s, o
+            // segmento sobrou de um simulador que morreu na abertura
+            for(int waited = 0; segment->magic != LIVE_MAGIC; waited++){
+                if(waited == 1000){
+                    cerr << name << " was never initialized" << endl;
+                    munmap(address, sizeof(liveSegment));
+                    return nullptr;
+                }
+                usleep(1000);
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if(segment->version != LIVE_VERSION){
+                cerr << name << " has version " << segment->version << ", expected " << LIVE_VERSION << endl;
+                munmap(address, sizeof(liveSegment));
+                return nullptr;
+            }
+            return segment;
+        }
+        if(once){
+            cerr << "No simulation publishing " << name << " (run it with --live)" << endl;
+            return nullptr;
+        }
+        if(!warned){
+            cerr << "Waiting for a simulation publishing " << name << "..." << endl;
+            warned = true;
+        }
+        usleep(interval * 1000);
+    }
+}
+
+static string pidList(const coreView &core){
+    string list;
+    for(int context = 0; context < LIVE_CONTEXTS; context++){
+        if(core.pids[context] != LIVE_NO_PID){
+            list += (list.empty() ? "" : ",") + to_string(core.pids[context]);
+        }
+    }
+    return list.empty() ? "-" : list;
+}
+
+static void show(const liveSegment &segment, const globalView &global, const vector<coreView> &cores,
+                 const globalView &previous, const vector<coreView> &previousCores, bool clear){
+    const double seconds = global.wallMs > previous.wallMs ? (global.wallMs - previous.wallMs) / 1000.0 : 0.0;
+    if(clear){
+        cout << "\033[H\033[2J";
+    }
+    cout << fixed << setprecision(1);
+    cout << "Simulator pid " << segment.simulatorPid << (global.running ? ", running" : ", finished")
+         << ": cycle " << global.cycle << ", wall " << global.wallMs / 1000.0 << " s";
+    if(seconds > 0){
+        cout << ", " << (global.cycle - previous.cycle) / seconds << " cycles/s";
+    }
+    cout << endl;
+    cout << "Processes: " << global.processes << " total, " << global.arriving << " arriving, " << global.ready
+         << " ready, " << global.executing << " executing, " << global.blocked << " blocked, " << global.finished
+         << " finished" << endl;
+    cout << "I/O: " << global.ioQueued << " queued, " << global.ioBusy << " in service, " << global.ioCompleted
+         << " completed" << endl;
+    cout << "Memory: " << global.memoryUsed << " words in use, " << global.memoryLoaded << " loaded, "
+         << global.memoryTotal << " total ("
+         << (global.memoryTotal ? 100.0 * global.memoryUsed / global.memoryTotal : 0.0) << "% in use)" << endl;
+    cout << endl << "  core  state  pids              cycle  instructions     instr/s   quanta" << endl;
+    for(size_t i = 0; i < cores.size(); i++){
+        const coreView &core = cores[i];
+        const double rate = seconds > 0 ? (core.instructions - previousCores[i].instructions) / seconds : 0.0;
+        cout << setw(6) << i << "  " << setw(5) << left << (core.state == LIVE_RUNNING ? "run" : "idle") << "  "
+             << setw(9) << pidList(core) << right << setw(14) << core.cycle << setw(14) << core.instructions
+             << setw(12) << rate << setw(9) << core.quanta << endl;
+    }
+    cout << defaultfloat << flush;
+}
+
+int main(int argc, char *argv[]){
+    string name = LIVE_DEFAULT_NAME;
+    unsigned interval = 1000;
+    bool once = false;
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "--name=", 7) == 0){
+            name = argv[i] + 7;
+        }else if(strncmp(argv[i], "--interval=", 11) == 0){
+            interval = max(10, atoi(argv[i] + 11));
+        }else if(strcmp(argv[i], "--once") == 0){
+            once = true;
+        }else{
+            cerr << "Usage: " << argv[0] << " [--name=/SHM_NAME] [--interval=MS] [--once]" << endl;
+            return 1;
+        }
+    }
+
+    const liveSegment *segment = attach(name, interval, once);
+    if(segment == nullptr){
+        return 1;
+    }
+    const uint32_t numCores = min<uint32_t>(segment->numCores, LIVE_MAX_CORES);
+
+    globalView previous{};
+    vector<coreView> previousCores(numCores);
+    if(!readSegment(*segment, previous, previousCores)){
+        cerr << "Simulator " << segment->simulatorPid << " exited in the middle of an update" << endl;
+        munmap((void*)segment, sizeof(liveSegment));
+        return 1;
+    }
+    if(!once){
+        usleep(interval * 1000);
+    }
+
+    for(;;){
+        globalView global = previous;
+        vector<coreView> cores = previousCores;
+        const bool read = readSegment(*segment, global, cores);
+        show(*segment, global, cores, previous, previousCores, !once);
+        if(!read){
+            cerr << "Simulator " << segment->simulatorPid << " exited in the middle of an update" << endl;
+            break;
+        }
+
+        // sem a última publicação (simulador morto) também encerra
+        if(once || !global.running || !simulatorAlive(*segment)){
+            break;
+        }
+        previous = global;
+        previousCores = cores;
+        usleep(interval * 1000);
+    }
+    munmap((void*)segment, sizeof(liveSegment));
+    return 0;
+}
@@ -0,0 +1,222 @@
+// Análise offline de um trace gravado com --trace: mistura de instruções,
+// distância de reuso dos endereços de dados e comportamento dos desvios, por
+// processo.
+#include "../sim/TRACE_RECORDER.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <unordered_map>
+
+// Árvore de Fenwick sobre a posição de cada acesso: marca o último acesso de
+// cada endereço, então a soma entre dois acessos ao mesmo endereço é o número
+// de endereços distintos usados no meio (distância de pilha LRU).
+struct fenwick {
+    vector<uint32_t> tree;
+    fenwick(size_t size) : tree(size + 1, 0) {}
+    void Add(size_t position, int value){
+        for(position += 1; position < tree.size(); position += position & -position){
+            tree[position] += value;
+        }
+    }
+    uint64_t Prefix(size_t position) const{    // soma de [0, position)
+        uint64_t sum = 0;
+        for(; position > 0; position -= position & -position){
+            sum += tree[position];
+        }
+        return sum;
+    }
+};
+
+#define REUSE_BUCKETS 24    // 0, 1, 2-3, 4-7, ... e o resto no último
+
+struct branchSite {
+    uint64_t executed = 0;
+    uint64_t taken = 0;
+    uint64_t predicted = 0;    // acertos de um contador de 2 bits
+    uint8_t counter = 1;       // começa em "fracamente não tomado"
+    uint32_t target = 0;
+};
+
+static string bucketName(int bucket){
+    if(bucket == 0){
+        return "0";
+    }
+    uint64_t low = 1ull << (bucket - 1);
+    if(bucket == REUSE_BUCKETS - 1){
+        return ">=" + to_string(low);
+    }
+    return low == 1 ? "1" : to_string(low) + "-" + to_string(2 * low - 1);
+}
+
+static void analyze(const vector<traceRecord> &records, const map<uint8_t, string> &opcodes, const string &name, size_t top){
+    cout << "[" << name << "] " << records.size() << " instructions, cycles " << records.front().cycle
+         << "-" << records.back().cycle << endl;
+
+    // mistura de instruções
+    map<uint8_t, uint64_t> mix;
+    uint64_t loads = 0, stores = 0, branches = 0;
+    for(const traceRecord &record : records){
+        mix[record.opcode] += 1;
+        loads += (record.flags & TRACE_LOAD) != 0;
+        stores += (record.flags & TRACE_STORE) != 0;
+        branches += (record.flags & TRACE_BRANCH) != 0;
+    }
+    vector<pair<uint8_t, uint64_t>> sorted(mix.begin(), mix.end());
+    sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b){ return a.second > b.second; });
+    const double total = records.size();
+    cout << fixed << setprecision(1);
+    cout << "  mix: loads " << 100.0 * loads / total << "%, stores " << 100.0 * stores / total
+         << "%, branches " << 100.0 * branches / total << "%" << endl;
+    for(const auto &[opcode, count] : sorted){
+        auto entry = opcodes.find(opcode);
+        cout << "    " << setw(8) << left << (entry == opcodes.end() ? "?" : entry->second) << right
+             << setw(10) << count << setw(8) << 100.0 * count / total << "%" << endl;
+    }
+
+    // distância de reuso dos endereços lidos e escritos
+    vector<uint32_t> accesses;
+    for(const traceRecord &record : records){
+        if(record.flags & (TRACE_LOAD | TRACE_STORE)){
+            accesses.push_back(record.address);
+        }
+    }
+    if(!accesses.empty()){
+        fenwick marks(accesses.size());
+        unordered_map<uint32_t, size_t> last;
+        uint64_t histogram[REUSE_BUCKETS] = {};
+        uint64_t cold = 0;
+        for(size_t t = 0; t < accesses.size(); t++){
+            auto previous = last.find(accesses[t]);
+            if(previous == last.end()){
+                cold += 1;
+            }else{
+                uint64_t distance = marks.Prefix(t) - marks.Prefix(previous->second + 1);
+                int bucket = distance == 0 ? 0 : min<int>(REUSE_BUCKETS - 1, 64 - __builtin_clzll(distance));
+                histogram[bucket] += 1;
+                marks.Add(previous->second, -1);
+            }
+            marks.Add(t, 1);
+            last[accesses[t]] = t;
+        }
+        cout << "  reuse distance: " << accesses.size() << " accesses, " << last.size()
+             << " distinct addresses, " << cold << " cold" << endl;
+        for(int bucket = 0; bucket < REUSE_BUCKETS; bucket++){
+            if(histogram[bucket] > 0){
+                cout << "    " << setw(12) << bucketName(bucket) << setw(10) << histogram[bucket]
+                     << setw(8) << 100.0 * histogram[bucket] / accesses.size() << "%" << endl;
+            }
+        }
+    }
+
+    // desvios: taxa de tomados e o quanto um preditor de 2 bits acertaria
+    map<uint32_t, branchSite> sites;
+    uint64_t conditional = 0, taken = 0, backward = 0, predicted = 0;
+    for(const traceRecord &record : records){
+        if(!(record.flags & TRACE_BRANCH)){
+            continue;
+        }
+        const bool isTaken = record.flags & TRACE_TAKEN;
+        branchSite &site = sites[record.pc];
+        site.executed += 1;
+        site.taken += isTaken;
+        site.target = record.address;
+        const string &opcode = opcodes.count(record.opcode) ? opcodes.at(record.opcode) : "";
+        if(opcode == "j" || opcode == "jal" || opcode == "jr"){
+            continue;
+        }
+        conditional += 1;
+        taken += isTaken;
+        backward += isTaken && record.address <= record.pc;
+        if((site.counter >= 2) == isTaken){
+            site.predicted += 1;
+            predicted += 1;
+        }
+        site.counter = isTaken ? min(3, site.counter + 1) : max(0, site.counter - 1);
+    }
+    if(branches > 0){
+        cout << "  branches: " << branches << " (" << conditional << " conditional, " << sites.size() << " sites)";
+        if(conditional > 0){
+            cout << ", taken " << 100.0 * taken / conditional << "% (backward " << 100.0 * backward / conditional
+                 << "%), 2-bit predictor " << 100.0 * predicted / conditional << "% correct";
+        }
+        cout << endl;
+        vector<pair<uint32_t, branchSite>> hot(sites.begin(), sites.end());
+        sort(hot.begin(), hot.end(), [](const auto &a, const auto &b){ return a.second.executed > b.second.executed; });
+        cout << "        pc    target  executed   taken  2-bit" << endl;
+        for(size_t i = 0; i < hot.size() && i < top; i++){
+            const branchSite &site = hot[i].second;
+            cout << setw(10) << hot[i].first << setw(10) << site.target << setw(10) << site.executed
+                 << setw(7) << 100.0 * site.taken / site.executed << "%"
+                 << setw(6) << 100.0 * site.predicted / site.executed << "%" << endl;
+        }
+    }
+    cout << defaultfloat;
+}
+
+int main(int argc, char *argv[]){
+    string path;
+    int onlyPid = -1;
+    size_t top = 10;
+    for(int i = 1; i < argc; i++){
+        if(strncmp(argv[i], "--pid=", 6) == 0){
+            onlyPid = stoi(argv[i] + 6);
+        }else if(strncmp(argv[i], "--top=", 6) == 0){
+            top = stoul(argv[i] + 6);
+        }else{
+            path = argv[i];
+        }
+    }
+    if(path.empty()){
+        cerr << "Usage: " << argv[0] << " [--pid=N] [--top=N] <trace_file>" << endl;
+        return 1;
+    }
+
+    FILE *file = fopen(path.c_str(), "rb");
+    if(file == nullptr){
+        cerr << "Error opening trace file " << path << endl;
+        return 1;
+    }
+    traceHeader header;
+    if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != TRACE_MAGIC
+        || header.version != TRACE_VERSION || header.recordSize != sizeof(traceRecord)){
+        cerr << "Not a trace file of this version: " << path << endl;
+        fclose(file);
+        return 1;
+    }
+    map<uint8_t, string> opcodes;
+    for(uint32_t i = 0; i < header.opcodeCount; i++){
+        traceOpcode entry;
+        if(fread(&entry, sizeof(entry), 1, file) != 1){
+            cerr << "Truncated opcode table in " << path << endl;
+            fclose(file);
+            return 1;
+        }
+        opcodes[entry.code] = string(entry.name, strnlen(entry.name, sizeof(entry.name)));
+    }
+
+    // os núcleos gravam intercalados: por processo, a ordem é a do ciclo
+    map<int, vector<traceRecord>> processes;
+    traceRecord buffer[4096];
+    size_t count;
+    while((count = fread(buffer, sizeof(traceRecord), 4096, file)) > 0){
+        for(size_t i = 0; i < count; i++){
+            if(onlyPid < 0 || buffer[i].pid == onlyPid){
+                processes[buffer[i].pid].push_back(buffer[i]);
+            }
+        }
+    }
+    fclose(file);
+
+    uint64_t total = 0;
+    for(auto &[pid, records] : processes){
+        stable_sort(records.begin(), records.end(), [](const traceRecord &a, const traceRecord &b){ return a.cycle < b.cycle; });
+        total += records.size();
+    }
+    cout << "Trace " << path << ": " << total << " instructions, " << processes.size() << " processes" << endl;
+    for(const auto &[pid, records] : processes){
+        analyze(records, opcodes, "process " + to_string(pid), top);
+    }
+    return 0;
+}
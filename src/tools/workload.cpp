@@ -0,0 +1,336 @@
+// Gerador de cargas sintéticas e harness de vazão.
+//
+//   Workload generate [opções] --count=N --dir=DIR
+//       escreve DIR/wl<seed>_<i>.asm
+//   Workload run [opções] --processes=N --cores=1,2,4 [--sim=BIN] [--csv=ARQ] [-- opções do simulador]
+//       gera N programas e roda o simulador com cada número de núcleos,
+//       imprimindo uma linha da curva de escalabilidade por execução
+//
+// Opções dos programas: --mix=alu:50,mul:10,mem:25,branch:10,call:5
+// --length=N (instruções no corpo do laço), --loop-depth=D, --trip=N (voltas de
+// cada laço), --footprint=N (palavras de dados), --io-every=N (uma E/S a cada N
+// instruções do corpo, 0 = nenhuma) e --seed=N.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+#define WORKLOAD_MAX_DEPTH 6        // contadores em $s0-$s5
+#define WORKLOAD_MAX_FOOTPRINT 32768    // alcance do deslocamento de lw/sw a partir de $s7
+
+enum workloadKind { KIND_ALU, KIND_MUL, KIND_MEM, KIND_BRANCH, KIND_CALL, NUM_KINDS };
+
+struct workloadConfig {
+    unsigned weights[NUM_KINDS] = {50, 10, 25, 10, 5};
+    unsigned length = 64;
+    unsigned depth = 2;
+    unsigned trip = 8;
+    unsigned footprint = 1024;
+    unsigned ioEvery = 0;
+    uint64_t seed = 1;
+};
+
+// Registradores: $t0-$t8 operandos, $t9 = 7 (divisor), $s0-$s5 contadores dos
+// laços, $a3 = voltas por laço, $s7 = base dos dados.
+static string temp(mt19937_64 &random){
+    return "$t" + to_string(random() % 9);
+}
+
+static string generateProgram(const workloadConfig &config, uint64_t seed){
+    mt19937_64 random(seed);
+    discrete_distribution<int> kinds(begin(config.weights), end(config.weights));
+    ostringstream out;
+    unsigned labels = 0;
+
+    out << ".data\n\ndata:\t 0";
+    for(unsigned i = 1; i < config.footprint; i++){
+        out << "," << (random() % 100);
+    }
+    out << "\n\n.text\n\n";
+    out << "# gerado pelo Workload: seed " << seed << ", " << config.length << " instruções no corpo, "
+        << config.depth << " laços de " << config.trip << " voltas\n";
+    out << "main:\n";
+    for(int i = 0; i < 9; i++){
+        out << "    li $t" << i << ", " << (random() % 1000 + 1) << "\n";
+    }
+    out << "    li $t9, 7\n";
+    out << "    li $a3, " << config.trip << "\n";
+    out << "    la $s7, data\n";
+
+    // cada label precisa de um j antes: o montador não deixa o código cair nele
+    for(unsigned d = 0; d < config.depth; d++){
+        out << "    li $s" << d << ", 0\n";
+        out << "    j loop" << d << "\n";
+        out << "loop" << d << ":\n";
+    }
+
+    unsigned io = 0;
+    for(unsigned i = 0; i < config.length; i++){
+        if(config.ioEvery > 0 && i % config.ioEvery == config.ioEvery - 1){
+            switch(io++ % 3){
+            case 0: out << "    print " << temp(random) << "\n"; break;
+            case 1: out << "    dwrite " << temp(random) << ", " << random() % 64 << "\n"; break;
+            default: out << "    dread " << temp(random) << ", " << random() % 64 << "\n"; break;
+            }
+            continue;
+        }
+        switch(kinds(random)){
+        case KIND_ALU: {
+            // só o que o Control_Unit executa: and é montado, mas não tem caso no decode
+            static const char* ops[] = {"add", "sub"};
+            if(random() % 4 == 0){
+                out << "    addi " << temp(random) << ", " << temp(random) << ", " << (int)(random() % 64) - 32 << "\n";
+            }else{
+                out << "    " << ops[random() % 2] << " " << temp(random) << ", " << temp(random) << ", " << temp(random) << "\n";
+            }
+            break;
+        }
+        case KIND_MUL:
+            if(random() % 2 == 0){
+                out << "    mult " << temp(random) << ", " << temp(random) << ", " << temp(random) << "\n";
+            }else{
+                out << "    div " << temp(random) << ", " << temp(random) << ", $t9\n";
+            }
+            break;
+        case KIND_MEM:
+            out << "    " << (random() % 3 == 0 ? "sw " : "lw ") << temp(random) << ", "
+                << random() % config.footprint << "($s7)\n";
+            break;
+        case KIND_BRANCH: {
+            // desvio para frente sobre uma instrução
+            const unsigned label = labels++;
+            out << "    " << (random() % 2 ? "blt " : "bgt ") << temp(random) << ", " << temp(random) << ", skip" << label << "\n";
+            out << "    addi " << temp(random) << ", " << temp(random) << ", 1\n";
+            out << "    j skip" << label << "\n";
+            out << "skip" << label << ":\n";
+            break;
+        }
+        case KIND_CALL:
+            out << "    jal leaf\n";
+            break;
+        }
+    }
+
+    for(int d = config.depth - 1; d >= 0; d--){
+        out << "    addi $s" << d << ", $s" << d << ", 1\n";
+        out << "    blt $s" << d << ", $a3, loop" << d << "\n";
+    }
+    out << "    j done\n\n";
+    out << "leaf:\n";
+    out << "    add $v0, $t0, $t1\n";
+    out << "    jr $ra\n\n";
+    out << "done:\n";
+    out << "    end\n";
+    return out.str();
+}
+
+static bool parseMix(const string &mix, workloadConfig &config){
+    static const map<string, workloadKind> names = {
+        {"alu", KIND_ALU}, {"mul", KIND_MUL}, {"mem", KIND_MEM}, {"branch", KIND_BRANCH}, {"call", KIND_CALL}};
+    fill(begin(config.weights), end(config.weights), 0);
+    stringstream entries(mix);
+    string entry;
+    while(getline(entries, entry, ',')){
+        size_t colon = entry.find(':');
+        auto kind = names.find(entry.substr(0, colon));
+        if(colon == string::npos || kind == names.end()){
+            return false;
+        }
+        config.weights[kind->second] = stoul(entry.substr(colon + 1));
+    }
+    unsigned total = 0;
+    for(unsigned weight : config.weights){
+        total += weight;
+    }
+    return total > 0;
+}
+
+static vector<string> writePrograms(const workloadConfig &config, unsigned count, const string &dir){
+    filesystem::create_directories(dir);
+    vector<string> paths;
+    for(unsigned i = 1; i <= count; i++){
+        string path = dir + "/wl" + to_string(config.seed) + "_" + to_string(i) + ".asm";
+        ofstream file(path);
+        file << generateProgram(config, config.seed * 1000003 + i);
+        paths.push_back(path);
+    }
+    return paths;
+}
+
+// Métricas das linhas de --stats do simulador.
+struct runResult {
+    unsigned cores = 0;
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    double ipc = 0;
+    double mips = 0;
+    uint64_t cyclesPerSecond = 0;
+    uint64_t simWallMs = 0;
+    double wallMs = 0;
+    uint64_t dispatches = 0;
+    uint64_t turnaround = 0;
+    uint64_t maxTurnaround = 0;
+    uint64_t wait = 0;
+    uint64_t maxWait = 0;
+    bool ok = false;
+};
+
+static runResult runSimulator(const string &sim, unsigned cores, const vector<string> &programs, const string &simArgs){
+    runResult result;
+    result.cores = cores;
+    string command = sim + " --stats --cores=" + to_string(cores) + " " + simArgs;
+    for(const string &program : programs){
+        command += " " + program;
+    }
+    command += " 2>&1 >/dev/null";
+
+    auto start = chrono::steady_clock::now();
+    FILE *pipe = popen(command.c_str(), "r");
+    if(pipe == nullptr){
+        return result;
+    }
+    char line[512];
+    bool throughput = false, scheduler = false;
+    while(fgets(line, sizeof(line), pipe)){
+        const char *wall = strstr(line, "wall time ");
+        if(strncmp(line, "Simulated time: ", 16) == 0 && wall){
+            sscanf(line, "Simulated time: %lu cycles", &result.cycles);
+            sscanf(wall, "wall time %lu ms", &result.simWallMs);
+        }else if(strncmp(line, "Throughput: ", 12) == 0){
+            throughput = sscanf(line, "Throughput: %lu instructions on %*u cores, IPC %lf, %lf simulated MIPS, %lu simulated cycles/s",
+                &result.instructions, &result.ipc, &result.mips, &result.cyclesPerSecond) == 4;
+        }else if(strncmp(line, "Scheduler: ", 11) == 0){
+            scheduler = sscanf(line, "Scheduler: %*u processes, %lu dispatches, turnaround avg %lu max %lu cycles, ready wait avg %lu max %lu cycles",
+                &result.dispatches, &result.turnaround, &result.maxTurnaround, &result.wait, &result.maxWait) == 5;
+        }
+    }
+    const int status = pclose(pipe);
+    result.wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    result.ok = status == 0 && throughput && scheduler;
+    return result;
+}
+
+static void usage(const char *name){
+    cerr << "Usage: " << name << " generate [--count=N] [--dir=DIR] [program options]" << endl
+         << "       " << name << " run [--processes=N] [--cores=1,2,4] [--sim=BIN] [--dir=DIR] [--csv=FILE] [program options] [-- simulator options]" << endl
+         << "Program options: --mix=alu:50,mul:10,mem:25,branch:10,call:5 --length=N --loop-depth=N --trip=N --footprint=WORDS --io-every=N --seed=N" << endl;
+}
+
+int main(int argc, char *argv[]){
+    if(argc < 2 || (strcmp(argv[1], "generate") != 0 && strcmp(argv[1], "run") != 0)){
+        usage(argv[0]);
+        return 1;
+    }
+    const bool run = strcmp(argv[1], "run") == 0;
+
+    workloadConfig config;
+    unsigned count = 4;
+    string dir = "programs/workload";
+    string csv;
+    string sim = (filesystem::path(argv[0]).parent_path() / "CustomVonNeumannMachine").string();
+    vector<unsigned> coreCounts = {1, 2, 4};
+    string simArgs;
+
+    for(int i = 2; i < argc; i++){
+        const char *arg = argv[i];
+        if(strcmp(arg, "--") == 0){
+            for(i++; i < argc; i++){
+                simArgs += string(argv[i]) + " ";
+            }
+        }else if(strncmp(arg, "--mix=", 6) == 0){
+            if(!parseMix(arg + 6, config)){
+                cerr << "Invalid mix: " << arg + 6 << endl;
+                return 1;
+            }
+        }else if(strncmp(arg, "--length=", 9) == 0){
+            config.length = stoul(arg + 9);
+        }else if(strncmp(arg, "--loop-depth=", 13) == 0){
+            config.depth = stoul(arg + 13);
+        }else if(strncmp(arg, "--trip=", 7) == 0){
+            config.trip = max(1ul, stoul(arg + 7));
+        }else if(strncmp(arg, "--footprint=", 12) == 0){
+            config.footprint = max(1ul, stoul(arg + 12));
+        }else if(strncmp(arg, "--io-every=", 11) == 0){
+            config.ioEvery = stoul(arg + 11);
+        }else if(strncmp(arg, "--seed=", 7) == 0){
+            config.seed = stoull(arg + 7);
+        }else if(strncmp(arg, "--count=", 8) == 0 || strncmp(arg, "--processes=", 12) == 0){
+            count = stoul(strchr(arg, '=') + 1);
+        }else if(strncmp(arg, "--dir=", 6) == 0){
+            dir = arg + 6;
+        }else if(strncmp(arg, "--csv=", 6) == 0){
+            csv = arg + 6;
+        }else if(strncmp(arg, "--sim=", 6) == 0){
+            sim = arg + 6;
+        }else if(strncmp(arg, "--cores=", 8) == 0){
+            coreCounts.clear();
+            stringstream list(arg + 8);
+            string value;
+            while(getline(list, value, ',')){
+                coreCounts.push_back(stoul(value));
+            }
+        }else{
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if(config.depth > WORKLOAD_MAX_DEPTH || config.footprint > WORKLOAD_MAX_FOOTPRINT){
+        cerr << "Loop depth is limited to " << WORKLOAD_MAX_DEPTH << " and footprint to " << WORKLOAD_MAX_FOOTPRINT << " words" << endl;
+        return 1;
+    }
+
+    vector<string> programs = writePrograms(config, count, dir);
+    if(!run){
+        for(const string &program : programs){
+            cout << program << endl;
+        }
+        return 0;
+    }
+
+    uint64_t dynamic = config.length;
+    for(unsigned d = 0; d < config.depth; d++){
+        dynamic *= config.trip;
+    }
+    cout << count << " processes of about " << dynamic << " instructions each, simulator " << sim << " " << simArgs << endl;
+    cout << " cores      cycles  instructions    IPC  sim MIPS    cycles/s   wall ms  speedup  dispatches  turnaround  ready wait" << endl;
+
+    ofstream table;
+    if(!csv.empty()){
+        table.open(csv);
+        table << "cores,cycles,instructions,ipc,sim_mips,cycles_per_second,sim_wall_ms,wall_ms,speedup,dispatches,turnaround_avg,turnaround_max,ready_wait_avg,ready_wait_max\n";
+    }
+
+    uint64_t baseline = 0;
+    for(unsigned cores : coreCounts){
+        runResult result = runSimulator(sim, cores, programs, simArgs);
+        if(!result.ok){
+            cerr << "Simulator run with " << cores << " cores failed" << endl;
+            return 1;
+        }
+        if(baseline == 0){
+            baseline = result.cycles;
+        }
+        const double speedup = result.cycles ? (double)baseline / result.cycles : 0.0;
+        cout << fixed << setw(6) << cores << setw(12) << result.cycles << setw(14) << result.instructions
+             << setprecision(3) << setw(7) << result.ipc << setw(10) << result.mips << setw(12) << result.cyclesPerSecond
+             << setprecision(1) << setw(10) << result.wallMs << setprecision(2) << setw(9) << speedup
+             << setw(12) << result.dispatches << setw(12) << result.turnaround << setw(12) << result.wait << endl;
+        if(table.is_open()){
+            table << cores << "," << result.cycles << "," << result.instructions << "," << result.ipc << "," << result.mips
+                  << "," << result.cyclesPerSecond << "," << result.simWallMs << "," << result.wallMs << "," << speedup
+                  << "," << result.dispatches << "," << result.turnaround << "," << result.maxTurnaround
+                  << "," << result.wait << "," << result.maxWait << "\n";
+        }
+    }
+    return 0;
+}
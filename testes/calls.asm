@@ -0,0 +1,62 @@
+.data
+
+n:	 10
+result:	 0
+
+.text
+
+main:
+    lw $a0, n
+    jal fib
+    sw $v0, result
+    print result        # fib(10) = 55
+
+    li $a0, 100
+    jal sum
+    print $v0           # 1 + 2 + ... + 100 = 5050
+    j done
+
+# fib(n) recursivo: $a0 = n, resultado em $v0
+fib:
+    li $t0, 2
+    blt $a0, $t0, fib_base
+    addi $sp, $sp, -3   # quadro: $ra, n, fib(n - 1)
+    sw $ra, 0($sp)
+    sw $a0, 1($sp)
+    addi $a0, $a0, -1
+    jal fib
+    sw $v0, 2($sp)
+    lw $a0, 1($sp)
+    addi $a0, $a0, -2
+    jal fib
+    lw $t1, 2($sp)
+    add $v0, $v0, $t1
+    lw $ra, 0($sp)
+    addi $sp, $sp, 3
+    jr $ra
+
+fib_base:
+    add $v0, $a0, $zero
+    jr $ra
+
+# soma de 1 a n com uma chamada por termo
+sum:
+    addi $sp, $sp, -1
+    sw $ra, 0($sp)
+    li $v0, 0
+    j sum_loop
+
+sum_loop:
+    jal add_term
+    addi $a0, $a0, -1
+    bgt $a0, $zero, sum_loop
+    lw $ra, 0($sp)
+    addi $sp, $sp, 1
+    jr $ra
+
+add_term:
+    add $v0, $v0, $a0
+    jr $ra
+
+done:
+    end
@@ -0,0 +1,18 @@
+.data
+
+total:	 0
+
+.text
+
+main:
+	li $t0, 7
+	dwrite $t0, 3           # Grava 7 no bloco 3 do disco
+	li $t1, 5
+	dwrite $t1, 4           # Grava 5 no bloco 4 do disco
+	sleep 20                # Espera 20 unidades do timer
+	dread $t2, 3            # Lê o bloco 3 (bloqueia até o disco responder)
+	dread $t3, 4
+	add $t4, $t2, $t3
+	print $t4               # 12
+	sw $t4, total
+	print total
@@ -0,0 +1,39 @@
+.data
+
+total:	 0
+
+.text
+
+# Cada volta tem um div e um mult independentes do resto do corpo. Em ordem o
+# EX fica preso pela latência deles; com --ooo as somas seguem em paralelo.
+main:
+    li $s0, 60000       # dividendo
+    li $s1, 1           # i
+    li $s2, 41          # limite
+    li $s3, 0           # soma de 60000 / i
+    li $s4, 0           # soma de i * i
+    li $s5, 0           # soma de i
+    li $s6, 0           # contagem
+    j loop
+
+loop:
+    div $t0, $s0, $s1
+    mult $t1, $s1, $s1
+    add $s5, $s5, $s1
+    addi $s6, $s6, 1
+    add $t2, $s5, $s6
+    addi $t3, $t2, 7
+    add $s3, $s3, $t0
+    add $s4, $s4, $t1
+    addi $s1, $s1, 1
+    blt $s1, $s2, loop
+
+    print $s3           # soma de 60000 / i, i = 1..40 (256700)
+    print $s4           # soma de i * i (22140)
+    print $s5           # 820
+    sw $s6, total
+    print total         # 40
+    j done
+
+done:
+    end
@@ -0,0 +1,32 @@
+.data
+
+total:	 0
+
+.text
+
+main:
+	li $t0, 0               # Contador
+	li $t6, 0               # Soma
+	li $t1, 1
+	li $t2, 2
+	add $t3, $t1, $t2       # Passo (3)
+	li $t4, 20
+	add $t5, $t4, $t4       # Limite (40)
+	li $t7, 5
+	li $t7, 7               # Sobrescreve o valor anterior
+	j loop
+
+done:
+	sw $t6, total
+	print total             # 315
+	print $t0               # 42
+	print $t7               # 7
+
+loop:
+	blt $t0, $t5, body      # Teste no topo do laço
+	j done
+
+body:
+	add $t0, $t0, $t3
+	add $t6, $t6, $t0
+	j loop
@@ -0,0 +1,38 @@
+.data
+
+a:	 1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20
+b:	 20,19,18,17,16,15,14,13,12,11,10,9,8,7,6,5,4,3,2,1
+c:	 0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0
+
+.text
+
+main:
+    li $t0, 20
+    setvl $t0           # vetores de 20 elementos
+    la $a0, a
+    la $a1, b
+    la $a2, c
+
+    vadd $a2, $a0, $a1  # c[i] = a[i] + b[i] = 21
+    vsum $t1, $a2
+    print $t1           # 420
+
+    vmul $a2, $a0, $a1  # c[i] = a[i] * b[i]
+    vsum $t1, $a2
+    print $t1           # 1540
+
+    vsub $a2, $a1, $a0  # c[i] = b[i] - a[i]
+    vsum $t1, $a2
+    print $t1           # 0
+
+    vcmp $a2, $a0, $a0  # c[i] = 1
+    vsum $t1, $a2
+    print $t1           # 20
+
+    vcmp $a2, $a0, $a1  # nenhum igual
+    vsum $t1, $a2
+    print $t1           # 0
+    j done
+
+done:
+    end